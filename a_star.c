@@ -30,13 +30,15 @@ double halpha(position s, position t, grid *G) {
 }
 
 
-// Structure "noeud" pour le tas min Q.
-typedef struct node {
-  position pos;        // position (.x,.y) d'un noeud u
-  double cost;         // coût[u]
-  double score;        // score[u] = coût[u] + h(u,end)
-  struct node* parent; // parent[u] = pointeur vers le père, NULL pour start
-} *node;
+// Les sommets sont les cases u = x*G.Y + y de la grille, et les
+// tableaux cost[u] (coût[u]) et parent[u] (case du père, -1 pour
+// start) remplacent les noeuds alloués un par un.
+//
+// Tas min Q de cases, de clé le score[u] = coût[u] + h(u,end) (cf.
+// HEAP_DEFINE() dans heap.h). Une entrée (score,u) fait 16 octets, et
+// le tas est 4-aire: les 4 fils d'une entrée occupent une ligne de
+// cache.
+HEAP_DEFINE_ARY(cell, double, int, HEAP_MIN, 4)
 
 
 // Les arêtes, connectant les 8 cases voisines de la grille, sont
@@ -64,8 +66,8 @@ double weight[]={
 };
 
 
-// Que doit renvoyer la fonction A_star(G,h) ?
-//---------------------------------------------
+// Que doit renvoyer la fonction A_star(G,h,path,len) ?
+//-----------------------------------------------------
 //
 // Votre fonction A_star(G,h) doit construire un chemin dans la grille
 // G, entre la position G.start et G.end, selon l'heuristique h() et
@@ -78,9 +80,13 @@ double weight[]={
 // enfermée entre 4 murs ou si G.end est sur un mur), il faut renvoyer
 // une valeur < 0.
 //
-// Sinon, il faut renvoyer le coût du chemin trouvé et remplir le
-// champs .mark de G pour que le chemin trouvé puisse être visualisé
-// par drawGrid(G) (plutard dans le main). Il faut, par convention,
+// Sinon, il faut renvoyer le coût du chemin trouvé, écrire dans *path
+// le tableau de ses *len cases de G.start à G.end (à libérer par
+// l'appelant; *path=NULL et *len=0 s'il n'y a pas de chemin), et
+// remplir le champs .mark de G pour que le chemin trouvé puisse être
+// visualisé par drawGrid(G) (plutard dans le main). Aucune variable
+// globale ne reçoit le chemin: une requête n'écrase pas le résultat
+// de la précédente. Il faut, par convention,
 // avoir G.mark[x][y] = M_PATH ssi la case (x,y) appartient au chemin
 // trouvé. Utilisez les touches a,z,+,-,p,c pour gérer la vitesse
 // d'affichage et de progression de l'algorithme par exemple.
@@ -92,48 +98,65 @@ double weight[]={
 // Comment gérer les ensembles P et Q ?
 //--------------------------------------
 //
-// Pour gérer l'ensemble P, servez-vous du champs G.mark[x][y] (=
-// M_USED ssi (x,y) est dans P). Par défaut, ce champs est initialisé
-// partout à M_NULL par toute fonction initGridXXX().
+// L'ensemble P est un tableau de bits, un par case u = x*G.Y+y (cf.
+// IN() et ADD() ci-dessous): 8 fois plus petit qu'un tableau d'octets,
+// il tient mieux dans le cache. On marque aussi G.mark[x][y] = M_USED
+// pour l'affichage. Par défaut, ce champs est initialisé partout à
+// M_NULL par toute fonction initGridXXX().
+//
+// Les voisins d'une case u qui ne sont pas des murs sont donnés par le
+// masque G.nbr[u] (calculé par maskGrid()): le voisin du bit k est la
+// case u+G.off[k], à la position around[k] relativement à u.
 //
-// Pour gérer l'ensemble Q, vous devez utiliser un tas min de noeuds
-// (type node) avec une fonction de comparaison (à créer) qui dépend
-// du champs .score des noeuds. Pour la fonction de comparaison faites
-// attention au fait que l'expression "(int)(8.1 - 8.2)" n'est pas
-// négative, mais nulle! Vous devez utilisez la gestion paresseuse du
+// Pour gérer l'ensemble Q, vous devez utiliser un tas min de cases
+// (type heap_cell) dont la clé est le score des cases. La clé étant
+// stockée dans le tas, les comparaisons ne demandent ni de suivre un
+// pointeur ni d'appeler une fonction de comparaison. Vous devez
+// utilisez la gestion paresseuse du
 // tas (cf. le paragraphe du cours à ce sujet, dans l'implémentation
 // de Dijkstra). Pensez qu'avec cette gestion paresseuse, la taille de
 // Q est au plus la somme des degrés des sommets dans la grille. Pour
-// visualiser un noeud de coordonnées (x,y) qui passe dans le tas Q
+// visualiser une case de coordonnées (x,y) qui passe dans le tas Q
 // vous pourrez mettre G.mark[x][y] = M_FRONT au moment où vous
 // l'ajoutez. Même si cela est tentant, il ne faut pas utiliser la
 // marque M_FRONT pour savoir si un sommet est dans Q. Le champs .mark
 // ne doit servir que pour l'ensemble P et l'affichage de la grille.
 // Pas pour le tas Q !
 
-int fcmp_node(const void *x, const void *y){
-  const double a = ((node)x)->score;
-  const double b = ((node)y)->score;
-  return (a<b) ? -1 : (a>b);
+// Renvoie le chemin de start à la case t, path[0..*len-1], en
+// remontant parent[], et marque M_PATH ses cases. Le parcours est
+// itératif: la longueur du chemin ne dépend pas de la taille de la
+// pile. Le tableau est à libérer par l'appelant.
+static position *extractPath(grid G, int *parent, int t, int *len){
+  int k = 0;
+  for(int v=t; v>=0; v=parent[v]) k++;
+  position *path = malloc(k*sizeof(position));
+  *len = k;
+  for(int v=t; v>=0; v=parent[v]){
+    path[--k] = (position){ .x = v/G.Y, .y = v%G.Y };
+    G.flag[v] = M_PATH;
+  }
+  return path;
 }
 
-node createNode(position po, double c, double s, node pa){
-  node e = malloc(sizeof(*e));
-  e->pos = po;
-  e->cost = c;
-  e->score = s;
-  e->parent = pa;
-  return e;
-}
+// Trace des opérations sur Q, rejouée par bench_heap pour comparer
+// les files de priorité (cf. bench_heap.c). Si trace!=NULL, A_star()
+// y écrit un enregistrement trace_op par ajout (id = case x*G.Y+y,
+// key = score) et par extraction (id = -1).
+typedef struct { double key; int id; } trace_op;
+static FILE *trace = NULL;
 
-void markPath(grid G, node x){
-  if(x){
-    G.mark[x->pos.x][x->pos.y] = M_PATH;
-    markPath(G, x->parent);
-  }
+static void record(double key, int id){
+  if(trace) fwrite(&(trace_op){ key, id }, sizeof(trace_op), 1, trace);
 }
 
-double A_star(grid G, heuristic h){
+// L'ensemble P: un bit par case, alloué par newP().
+#define IN(P,u)  ((P)[(u)>>3] >> ((u)&7) & 1)
+#define ADD(P,u) ((P)[(u)>>3] |= 1 << ((u)&7))
+static uint8_t *newP(int N){ return calloc((N+7)/8, 1); }
+
+double A_star(grid G, heuristic h, position **path, int *len){
+  *path = NULL, *len = 0;
   // Pensez à dessiner la grille avec drawGrid(G) à chaque fois que
   // possible, par exemple, lorsque vous ajoutez un sommet à P mais
   // aussi lorsque vous reconstruisez le chemin à la fin de la
@@ -141,42 +164,279 @@ double A_star(grid G, heuristic h){
   // M_FRONT (dans son champs .mark) pour le distinguer à l'affichage
   // des sommets de P (couleur différente).
 
-  // Après avoir extrait un noeud de Q, il ne faut pas le détruire,
-  // sous peine de ne plus pouvoir reconstruire le chemin trouvé !
-  // Une fonction createNode() peut simplifier votre code.
+  // Le chemin est reconstruit à la fin en remontant parent[] depuis
+  // G.end, avec extractPath().
 
   // Les bords de la grille sont toujours constitués de murs (V_WALL)
   // ce qui évite d'avoir à tester la validité des indices des
   // positions (sentinelle). Dit autrement, un chemin ne peut pas
   // s'échapper de la grille.
-  heap Q = heap_create(8*(G.X*G.Y), fcmp_node);
-  node start = createNode(G.start, 0, 0, NULL);
-  heap_add(Q,start);
-
-  while(!heap_empty(Q)){
-    node u = heap_pop(Q);
-    if(G.end.x == u->pos.x && G.end.y == u->pos.y){
-      markPath(G, u);
-      return u->cost;
+  int const N = G.X*G.Y;
+  double *cost = malloc(N*sizeof(double));
+  int *parent = malloc(N*sizeof(int));
+  uint8_t *P = newP(N);
+  for(int u=0; u<N; u++) cost[u] = DBL_MAX;
+  maskGrid(G);
+  heap_cell Q = heap_cell_create(G.X+G.Y); // grandit au besoin
+
+  int const s = G.start.x*G.Y + G.start.y;
+  int const t = G.end.x*G.Y + G.end.y;
+  cost[s] = 0, parent[s] = -1;
+  heap_cell_add(Q, 0, s);
+  record(0, s);
+
+  double d = -1;
+  int u;
+  while(heap_cell_pop(Q, NULL, &u)){
+    record(0, -1);
+    int const x = u/G.Y, y = u%G.Y;
+    if(u == t){
+      *path = extractPath(G, parent, t, len);
+      d = cost[t];
+      break;
+    }
+    if(IN(P,u)) continue;
+    ADD(P,u);
+    G.flag[u] = M_USED;
+    drawGrid(G);
+    for(unsigned m=G.nbr[u]; m; m&=m-1){ // voisins qui ne sont pas des murs
+      int const k = __builtin_ctz(m), v = u + G.off[k];
+      if(IN(P,v)) continue;
+      double const w = cost[u] + weight[G.cell[v]];
+      if(w >= cost[v]) continue; // une entrée au moins aussi bonne est dans Q
+      cost[v] = w, parent[v] = u;
+      position p = (position){ .x = x+around[k].x, .y = y+around[k].y };
+      double const score = w + h(p, G.end, &G);
+      G.flag[v] = M_FRONT;
+      heap_cell_add(Q, score, v);
+      record(score, v);
+      drawGrid(G);
+    }
+  }
+
+  heap_cell_destroy(Q);
+  free(P);
+  free(parent);
+  free(cost);
+  return d;
+}
+
+
+// Variante de A_star() sans gestion paresseuse: Q est un tas indexé
+// (cf. iheap dans heap.h) dont les ids sont les cases u = x*G.Y + y
+// de la grille. Chaque case est au plus une fois dans Q, et lorsqu'on
+// trouve un meilleur chemin vers une case de Q on diminue sa clé au
+// lieu d'ajouter une nouvelle entrée. Q a donc au plus G.X*G.Y
+// entrées (au lieu de 8 fois plus), et aucune entrée périmée ne sort
+// du tas.
+double A_star_indexed(grid G, heuristic h, position **path, int *len){
+  *path = NULL, *len = 0;
+  int const N = G.X*G.Y;
+  double *cost = malloc(N*sizeof(double)); // cost[u] = coût[u]
+  int *parent = malloc(N*sizeof(int));     // parent[u], -1 pour start
+  uint8_t *P = newP(N);
+  for(int u=0; u<N; u++) cost[u] = DBL_MAX;
+  maskGrid(G);
+  iheap Q = iheap_create(N);
+
+  int const s = G.start.x*G.Y + G.start.y;
+  int const t = G.end.x*G.Y + G.end.y;
+  cost[s] = 0, parent[s] = -1;
+  iheap_add(Q, s, 0);
+
+  double d = -1;
+  int u;
+  while((u = iheap_pop(Q)) >= 0){
+    int const x = u/G.Y, y = u%G.Y;
+    if(u == t){
+      *path = extractPath(G, parent, t, len);
+      d = cost[u];
+      break;
+    }
+    ADD(P,u);
+    G.flag[u] = M_USED;
+    drawGrid(G);
+    for(unsigned m=G.nbr[u]; m; m&=m-1){ // voisins qui ne sont pas des murs
+      int const k = __builtin_ctz(m), v = u + G.off[k];
+      if(IN(P,v)) continue;
+      double const w = cost[u] + weight[G.cell[v]];
+      if(w >= cost[v]) continue; // pas meilleur que le chemin connu
+      cost[v] = w, parent[v] = u;
+      position p = (position){ .x = x+around[k].x, .y = y+around[k].y };
+      iheap_decrease_key(Q, v, w + h(p, G.end, &G));
+      G.flag[v] = M_FRONT;
+      drawGrid(G);
+    }
+  }
+
+  iheap_destroy(Q);
+  free(P);
+  free(parent);
+  free(cost);
+  return d;
+}
+
+
+// Variante de A_star() avec une file monotone (cf. rheap et bqueue
+// dans heap.h): file radix si dial=false, file de Dial sinon. Les
+// poids de weight[] étant des multiples de 0.1, les coûts sont
+// multipliés par SCALE et arrondis pour devenir entiers, ainsi que
+// l'heuristique. Avec h0 (Dijkstra) ou une heuristique monotone les
+// clés extraites sont croissantes, et chaque ajout ou extraction se
+// fait en temps amorti constant (Dial) ou O(log C) sans comparaisons
+// de tas (radix). Comme pour A_star(), une case peut être plusieurs
+// fois dans Q et on ignore celles déjà dans P lorsqu'elles sortent.
+#define SCALE 10
+
+double A_star_monotone(grid G, heuristic h, bool dial, position **path, int *len){
+  *path = NULL, *len = 0;
+  int const N = G.X*G.Y;
+  int const nw = sizeof(weight)/sizeof(*weight);
+  unsigned w[nw], wmax = 0; // poids entiers
+  for(int i=0; i<nw; i++){
+    w[i] = (weight[i] > 0)? lround(SCALE*weight[i]) : 0;
+    if(w[i] > wmax) wmax = w[i];
+  }
+  unsigned *cost = malloc(N*sizeof(unsigned)); // cost[u] = coût[u]*SCALE
+  int *parent = malloc(N*sizeof(int));         // parent[u], -1 pour start
+  uint8_t *P = newP(N);
+  for(int u=0; u<N; u++) cost[u] = UINT_MAX;
+  maskGrid(G);
+  // pour hvo, la clé d'un voisin dépasse celle de u d'au plus wmax+SCALE
+  rheap R = dial? NULL : rheap_create();
+  bqueue B = dial? bqueue_create(wmax+SCALE+1) : NULL;
+
+  int const s = G.start.x*G.Y + G.start.y;
+  int const t = G.end.x*G.Y + G.end.y;
+  cost[s] = 0, parent[s] = -1;
+  if(dial) bqueue_add(B, 0, s); else rheap_add(R, 0, s);
+
+  double d = -1;
+  int u;
+  while((u = dial? bqueue_pop(B, NULL) : rheap_pop(R, NULL)) >= 0){
+    int const x = u/G.Y, y = u%G.Y;
+    if(IN(P,u)) continue;
+    if(u == t){
+      *path = extractPath(G, parent, t, len);
+      d = (double)cost[u]/SCALE;
+      break;
+    }
+    ADD(P,u);
+    G.flag[u] = M_USED;
+    drawGrid(G);
+    for(unsigned m=G.nbr[u]; m; m&=m-1){ // voisins qui ne sont pas des murs
+      int const k = __builtin_ctz(m), v = u + G.off[k];
+      if(IN(P,v)) continue;
+      unsigned const g = cost[u] + w[G.cell[v]];
+      if(g >= cost[v]) continue; // pas meilleur que le chemin connu
+      cost[v] = g, parent[v] = u;
+      position p = (position){ .x = x+around[k].x, .y = y+around[k].y };
+      unsigned const key = g + lround(SCALE*h(p, G.end, &G));
+      if(dial) bqueue_add(B, key, v); else rheap_add(R, key, v);
+      G.flag[v] = M_FRONT;
+      drawGrid(G);
     }
-    if(G.mark[u->pos.x][u->pos.y] == M_USED) continue;
-    G.mark[u->pos.x][u->pos.y] = M_USED; 
+  }
+
+  if(dial) bqueue_destroy(B); else rheap_destroy(R);
+  free(P);
+  free(parent);
+  free(cost);
+  return d;
+}
+
+
+// Variante bidirectionnelle de A_star(): une recherche avant depuis
+// G.start (ensemble P, marqué M_USED) et une recherche arrière depuis
+// G.end (ensemble P_t, marqué M_USED2), chacune avec son tas
+// paresseux. Le poids de l'arête u->v étant celui de la case
+// d'arrivée v, la recherche arrière, qui parcourt les arêtes à
+// l'envers, donne aux voisins v de u le coût coût_t[v] = coût_t[u] +
+// weight[u]: coût_t[v] est le coût d'un chemin de v à G.end, sans le
+// poids de v, et coût[v] + coût_t[v] est celui d'un chemin de G.start
+// à G.end passant par v. On retient le meilleur, mu, à chaque
+// relaxation.
+//
+// L'heuristique est "équilibrée": avec pf(v) = (h(v,end) - h(start,v))/2,
+// la clé d'une case est coût[v] + pf(v) en avant et coût_t[v] - pf(v)
+// en arrière. Les deux recherches sont alors un Dijkstra sur le même
+// graphe aux poids modifiés, positifs si h est monotone (h0, ou hvo
+// sans tunnel), et on s'arrête dès que la somme des deux clés minimum
+// atteint mu. On étend à chaque fois le côté de plus petite clé.
+double A_star_bidir(grid G, heuristic h, position **path, int *len){
+  *path = NULL, *len = 0;
+  int const N = G.X*G.Y;
+  int const s = G.start.x*G.Y + G.start.y;
+  int const t = G.end.x*G.Y + G.end.y;
+  if(s != t && G.value[G.end.x][G.end.y] == V_WALL) return -1;
+
+  // indice 0 pour la recherche avant, 1 pour la recherche arrière
+  double *cost[2], mu = (s == t)? 0 : DBL_MAX;
+  int *parent[2], meet = (s == t)? s : -1;
+  uint8_t *P[2];
+  heap_cell Q[2];
+  for(int b=0; b<2; b++){
+    cost[b] = malloc(N*sizeof(double));
+    parent[b] = malloc(N*sizeof(int)); // vers start (b=0) ou end (b=1)
+    P[b] = newP(N);
+    Q[b] = heap_cell_create(G.X+G.Y);
+    for(int u=0; u<N; u++) cost[b][u] = DBL_MAX;
+  }
+  maskGrid(G);
+
+  cost[0][s] = 0, parent[0][s] = -1;
+  cost[1][t] = 0, parent[1][t] = -1;
+  // clés des départs avec leur potentiel, comme toutes les autres
+  // entrées, pour que le test d'arrêt compare des clés de même origine
+  heap_cell_add(Q[0], (h(G.start, G.end, &G) - h(G.start, G.start, &G))/2, s);
+  heap_cell_add(Q[1], -(h(G.end, G.end, &G) - h(G.start, G.end, &G))/2, t);
+
+  for(;;){
+    double key[2];
+    int u = -1;
+    for(int b=0; b<2; b++) // retire les entrées périmées du sommet
+      while(heap_cell_top(Q[b], &key[b], &u) && IN(P[b],u))
+        heap_cell_pop(Q[b], NULL, NULL);
+    if(heap_cell_empty(Q[0]) || heap_cell_empty(Q[1])) break;
+    if(key[0] + key[1] >= mu) break; // mu ne peut plus diminuer
+    int const b = (key[1] < key[0]);
+    heap_cell_pop(Q[b], NULL, &u);
+    int const x = u/G.Y, y = u%G.Y;
+    ADD(P[b],u);
+    G.flag[u] = b? M_USED2 : M_USED;
     drawGrid(G);
-    for(int c=u->pos.x-1; c <= u->pos.x+1 ; c++){
-      for(int l=u->pos.y-1; l<=u->pos.y+1; l++){
-        if(G.mark[c][l] == M_USED) continue;
-        if(G.value[c][l] == V_WALL) continue;
-        double cost = u->cost + weight[G.value[c][l]];
-        position p = (position){ .x = c, .y = l};
-        node v = createNode(p, cost, cost + h(p, G.end, &G), u);
-        G.mark[c][l] = M_FRONT;
-        heap_add(Q,v);
-        drawGrid(G);
-      }
+    double const wu = weight[G.cell[u]]; // poids des arêtes v->u
+    for(unsigned m=G.nbr[u]; m; m&=m-1){ // voisins qui ne sont pas des murs
+      int const k = __builtin_ctz(m), v = u + G.off[k];
+      if(IN(P[b],v)) continue;
+      double const w = cost[b][u] + (b? wu : weight[G.cell[v]]);
+      if(w >= cost[b][v]) continue; // pas meilleur que le chemin connu
+      cost[b][v] = w, parent[b][v] = u;
+      if(cost[!b][v] < DBL_MAX && w + cost[!b][v] < mu)
+        mu = w + cost[!b][v], meet = v;
+      position p = (position){ .x = x+around[k].x, .y = y+around[k].y };
+      double const pf = (h(p, G.end, &G) - h(G.start, p, &G))/2;
+      heap_cell_add(Q[b], b? w - pf : w + pf, v);
+      if(!IN(P[!b],v)) G.flag[v] = M_FRONT;
+      drawGrid(G);
     }
   }
 
-  return -1;
+  double d = -1;
+  if(meet >= 0){
+    // raccorde le chemin arrière meet->end aux pères de la recherche avant
+    for(int v=meet; v!=t; v=parent[1][v]) parent[0][parent[1][v]] = v;
+    *path = extractPath(G, parent[0], t, len);
+    d = mu;
+  }
+
+  for(int b=0; b<2; b++){
+    heap_cell_destroy(Q[b]);
+    free(P[b]);
+    free(parent[b]);
+    free(cost[b]);
+  }
+  return d;
 }
 
 
@@ -191,51 +451,18 @@ double A_star(grid G, heuristic h){
 //     faible). Bien sûr, votre modification ne doit en rien changer
 //     la distance (la somme des coût) entre .start et .end.
 //
-// (2) Modifier votre implémentation du tas dans heap.c de façon à
-//     utiliser un tableau de taille variable, en utilisant realloc()
-//     et une stratégie "doublante": lorsqu'il n'y a pas plus assez de
-//     place dans le tableau, on double sa taille avec un realloc().
-//     On peut imaginer que l'ancien paramètre 'nmax' devienne non pas
-//     le nombre maximal d'éléments, mais sa taille maximale initiale
-//     (comme par exemple nmax=4).
+// (2) [Fait] Les tas de heap.c et de HEAP_DEFINE() utilisent un
+//     tableau de taille variable, avec une stratégie "doublante":
+//     lorsqu'il n'y a plus assez de place dans le tableau, on double
+//     sa taille avec un realloc(). L'ancien paramètre 'nmax' n'est
+//     plus le nombre maximal d'éléments, mais la taille initiale.
 //
-// (3) Gérer plus efficacement la mémoire en libérant les noeuds
-//     devenus inutiles. Pour cela on ajoute un champs .nchild à la
-//     structure node, permettant de gérer le nombre de fils qu'un
-//     node de P ou Q possède. C'est relativement léger et facile à
-//     gérer puisqu'on augmente .nchild de u chaque fois qu'on fait
-//     parent[v]=p, soit juste après "node v = createNode(p,...)".
-//     Pensez à faire .nchild=0 dans createNode(). Notez bien qu'ici
-//     on parle de "node", donc de copie de sommet.
-//
-//     L'observation utile est que tous les nodes de Q sont des
-//     feuilles. On va alors pouvoir se débarrasser de tous les nodes
-//     ancêtres de ces feuilles simplement en extrayant les nodes de Q
-//     dans n'importe quel ordre. (Si on veut être plus efficace que
-//     |Q|*log|Q|, on peut vider le tableau .array[] directement sans
-//     passer par heap_pop(). Pour être propre, il faudrait peut-être
-//     ajouter une fonctions comme "void* heap_get(int i)" qui
-//     permettrait d'extraire l'objet numéro i sans modifier le tas,
-//     et renvoie NULL s'il est vide). On supprime alors chaque node,
-//     en mettant à jour le nombre de fils de son père, puis en
-//     supprimant le père s'il devient feuille (son .nchild passe 0)
-//     et ainsi de suite. On élimine ainsi l'arbre par branches qui se
-//     terminent toutes dans Q.
-//
-//     Ce processus peut ne pas fonctionner si P contient des nodes
-//     qui sont des feuilles. L'observation est que de tels nodes ne
-//     peuvent pas être sur le chemin s->t. On peut donc les supprimer
-//     au fur et à mesure directement dans la boucle principale quand
-//     on les détecte. On voit qu'un tel node apparaît si après avoir
-//     parcouru tous les voisins de u aucun node v n'est créé (et
-//     ajouté dans Q). Il suffit donc de savoir si on est passé par
-//     heap_add() (ou encore de comparer la taille de Q avant et après
-//     la boucle sur les voisins). Si u est une feuille, on peut alors
-//     supprimer le node u, mettre à jour .nchild de son père et
-//     remonter la branche jusqu'à trouver un node qui n'est plus une
-//     feuille. C'est donc la même procédure d'élagage que précdemment
-//     qu'on pourrait capturer par une fonction freeNode(node p).
-
+// (3) [Fait] A_star() n'alloue plus un noeud par relaxation (qui
+//     n'étaient jamais libérés): coût et père de chaque case sont
+//     dans les tableaux cost[] et parent[], une entrée de Q ne fait
+//     que 16 octets (score et case), et le chemin est reconstruit
+//     itérativement par extractPath(). Il n'y a donc plus d'arbre de
+//     noeuds à élaguer.
 
 int main(int argc, char *argv[]){
 
@@ -277,11 +504,28 @@ int main(int argc, char *argv[]){
   update = false; // accélère les dessins répétitifs
 
   alpha=0;
-  double d = A_star(G,hvo); // heuristique: h0, hvo, alpha*hvo
+  // file Q: tas avec gestion paresseuse (LAZY), tas indexé (INDEXED),
+  // file radix (RADIX) ou de Dial (DIAL) sur des coûts entiers, ou
+  // recherche bidirectionnelle avec deux tas paresseux (BIDIR)
+  enum { LAZY, INDEXED, RADIX, DIAL, BIDIR } mode=INDEXED;
+  //mode=LAZY, trace=fopen("astar.trace","wb"); // trace pour bench_heap
+  heuristic h=hvo; // heuristique: h0, hvo, alpha*hvo
+  position *path; // chemin trouvé, path[0..len-1]
+  int len;
+  double d;
+  switch(mode){
+  case LAZY:    d = A_star(G,h,&path,&len); break;
+  case INDEXED: d = A_star_indexed(G,h,&path,&len); break;
+  case RADIX:   d = A_star_monotone(G,h,false,&path,&len); break;
+  case DIAL:    d = A_star_monotone(G,h,true,&path,&len); break;
+  case BIDIR:   d = A_star_bidir(G,h,&path,&len); break;
+  }
+
+  if (trace) fclose(trace);
 
   // chemin trouvé ou pas ?
   if (d < 0) printf("path not found!\n");
-  else printf("bingo!!! cost of the path: %g\n", d);
+  else printf("bingo!!! cost of the path: %g (%i cells)\n", d, len);
 
   // compte le nombre de sommets explorés pour comparer les
   // heuristiques
@@ -297,6 +541,7 @@ int main(int argc, char *argv[]){
     handleEvent(true); // attend un évènement
   }
 
+  free(path);
   freeGrid(G);
   cleaning_SDL_OpenGL();
   return 0;
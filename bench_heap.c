@@ -0,0 +1,337 @@
+/*
+   bench_heap.c
+
+   Mesure, sans interaction, les performances des files de priorité de
+   heap.c et heap.h, et affiche les résultats au format CSV:
+
+     variant,workload,n,ops,seconds,mops,p50_ns,p99_ns,p999_ns
+
+   Variantes: le tas void* (heap), les tas typés binaire, 4-aire et
+   8-aire (HEAP_DEFINE_ARY), le tas indexé (iheap), la file radix
+   (rheap) et la file de Dial (bqueue).
+
+   Charges, pour n = 1e3, 1e4, ... jusqu'à nmax:
+
+     push  = n ajouts de clés aléatoires dans [0,KEYS[ dans une file vide
+     pop   = n extractions depuis une file de n clés
+     mixed = n fois "extraire k puis ajouter k+r", r aléatoire dans
+             [0,KEYS[, dans une file de n clés (modèle "hold": la file
+             garde sa taille et les clés sont monotones, comme pour
+             Dijkstra)
+
+   Chaque charge est exécutée deux fois: une fois pour le débit
+   (seconds, mops = millions d'opérations par seconde), et une fois en
+   chronométrant individuellement une opération sur stride pour les
+   percentiles de latence (p50, p99, p999, en nanosecondes).
+
+   Les traces enregistrées par A_star() dans a_star.c (cf. trace) sont
+   rejouées par chaque variante (workload = trace:fichier). Une trace
+   vient de la gestion paresseuse: pour le tas indexé, l'ajout d'une
+   case déjà dans la file devient une diminution de clé, et pour les
+   files radix et Dial les clés sont multipliées par SCALE, comme dans
+   A_star_monotone().
+
+   Usage: ./bench_heap [nmax] [trace ...]
+   Ex.:   ./bench_heap 1e6 astar.trace > bench.csv
+*/
+
+#include "heap.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#define KEYS (1<<16)   // clés aléatoires dans [0,KEYS[
+#define SCALE 10       // cf. A_star_monotone() dans a_star.c
+#define SAMPLES 200000 // nombre max d'opérations chronométrées
+
+enum{ PUSH, POP, MIXED }; // les charges
+char *workload[] = { "push", "pop", "mixed" };
+
+// Une opération de trace, cf. A_star() dans a_star.c.
+typedef struct { double key; int id; } trace_op;
+
+// Temps courant en nanosecondes.
+static inline uint64_t now(void){
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t)t.tv_sec*1000000000u + t.tv_nsec;
+}
+
+////////////////////////////////////////////////////
+//
+// Les variantes. Chacune fournit, en static inline pour ne pas
+// pénaliser les tas développés sur place:
+//
+//   void v_init(v *Q, int k, int N); // place initiale k, ids dans [0,N[
+//   void v_free(v *Q);
+//   void v_push(v *Q, unsigned key, double dkey, int id);
+//   int  v_pop(v *Q, unsigned *key); // id extrait, -1 si vide
+//
+// key est la clé entière, dkey la même clé en double (ou la clé
+// d'origine pour une trace). Les ids des ajouts sont distincts des ids
+// présents, sauf pour les traces.
+
+// tas void*: les objets sont des entrées d'une réserve, recyclées par
+// une pile d'entrées libres
+typedef struct { double key; unsigned ikey; int id; } entry;
+typedef struct { heap h; entry *pool; int *free, nfree, used, size; } voidp;
+
+static int fcmp_entry(const void *x, const void *y){
+  double const a = ((entry*)x)->key, b = ((entry*)y)->key;
+  return (a<b)? -1 : (a>b);
+}
+static inline void voidp_init(voidp *Q, int k, int N){
+  Q->h = heap_create(k, fcmp_entry);
+  Q->size = k;
+  Q->pool = malloc(k*sizeof(entry));
+  Q->free = malloc(k*sizeof(int));
+  Q->nfree = Q->used = 0;
+}
+static inline void voidp_free(voidp *Q){
+  heap_destroy(Q->h), free(Q->pool), free(Q->free);
+}
+static inline void voidp_push(voidp *Q, unsigned key, double dkey, int id){
+  int const e = Q->nfree? Q->free[--Q->nfree] : Q->used++;
+  Q->pool[e] = (entry){ dkey, key, id };
+  heap_add(Q->h, &Q->pool[e]);
+}
+static inline int voidp_pop(voidp *Q, unsigned *key){
+  entry *e = heap_pop(Q->h);
+  if(e == NULL) return -1;
+  Q->free[Q->nfree++] = e - Q->pool;
+  *key = e->ikey;
+  return e->id;
+}
+
+// tas typés binaire, 4-aire et 8-aire: la valeur est l'id, et la clé
+// entière est retrouvée par arrondi (les clés sont entières, sauf pour
+// les traces où elle ne sert pas)
+HEAP_DEFINE(d2, double, int, HEAP_MIN)
+HEAP_DEFINE_ARY(d4, double, int, HEAP_MIN, 4)
+HEAP_DEFINE_ARY(d8, double, int, HEAP_MIN, 8)
+
+#define TYPED(name)                                                     \
+  typedef heap_##name name;                                             \
+  static inline void name##_init(name *Q, int k, int N){                \
+    *Q = heap_##name##_create(k);                                       \
+  }                                                                     \
+  static inline void name##_free(name *Q){ heap_##name##_destroy(*Q); } \
+  static inline void name##_push(name *Q, unsigned key, double dkey, int id){ \
+    heap_##name##_add(*Q, dkey, id);                                    \
+  }                                                                     \
+  static inline int name##_pop(name *Q, unsigned *key){                 \
+    double k;                                                           \
+    int id;                                                             \
+    if(!heap_##name##_pop(*Q, &k, &id)) return -1;                      \
+    *key = (unsigned)k;                                                 \
+    return id;                                                          \
+  }
+TYPED(d2)
+TYPED(d4)
+TYPED(d8)
+
+// tas indexé: un id déjà présent voit sa clé diminuer
+typedef iheap indexed;
+static inline void indexed_init(indexed *Q, int k, int N){ *Q = iheap_create(N); }
+static inline void indexed_free(indexed *Q){ iheap_destroy(*Q); }
+static inline void indexed_push(indexed *Q, unsigned key, double dkey, int id){
+  iheap_decrease_key(*Q, id, dkey);
+}
+static inline int indexed_pop(indexed *Q, unsigned *key){
+  int const id = iheap_top(*Q);
+  if(id >= 0) *key = (unsigned)(*Q)->key[id], iheap_pop(*Q);
+  return id;
+}
+
+// files monotones
+typedef rheap radix;
+static inline void radix_init(radix *Q, int k, int N){ *Q = rheap_create(); }
+static inline void radix_free(radix *Q){ rheap_destroy(*Q); }
+static inline void radix_push(radix *Q, unsigned key, double dkey, int id){
+  rheap_add(*Q, key, id);
+}
+static inline int radix_pop(radix *Q, unsigned *key){ return rheap_pop(*Q, key); }
+
+typedef bqueue dial;
+static inline void dial_init(dial *Q, int k, int N){ *Q = bqueue_create(KEYS); }
+static inline void dial_free(dial *Q){ bqueue_destroy(*Q); }
+static inline void dial_push(dial *Q, unsigned key, double dkey, int id){
+  bqueue_add(*Q, key, id);
+}
+static inline int dial_pop(dial *Q, unsigned *key){ return bqueue_pop(*Q, key); }
+
+////////////////////////////////////////////////////
+//
+// Les exécutions. run_v(w,n,R,lat,stride) exécute la charge w pour n
+// avec les nombres aléatoires R[0..2n-1] et renvoie la durée en
+// secondes de la partie mesurée. Si lat!=NULL, une opération sur
+// stride est chronométrée et sa durée (ns) écrite dans lat[], dont le
+// nombre d'éléments est renvoyé dans *m. replay_v() fait de même pour
+// une trace T[0..t-1] d'ids dans [0,N[.
+
+#define TIMED(op)                                                       \
+  if(lat && i%stride == 0){                                             \
+    uint64_t const t0 = now();                                          \
+    op;                                                                 \
+    lat[(*m)++] = now() - t0;                                           \
+  }else{ op; }
+
+#define RUN(v)                                                          \
+  static double run_##v(int w, int n, unsigned *R,                      \
+                        double *lat, int stride, int *m){               \
+    v Q;                                                                \
+    unsigned key = 0;                                                   \
+    int id;                                                             \
+    v##_init(&Q, n, n);                                                 \
+    if(w != PUSH)                                                       \
+      for(int i=0; i<n; i++) v##_push(&Q, R[i], R[i], i);               \
+    *m = 0;                                                             \
+    uint64_t const t0 = now();                                          \
+    for(int i=0; i<n; i++){                                             \
+      switch(w){                                                        \
+      case PUSH: TIMED(v##_push(&Q, R[n+i], R[n+i], i)); break;         \
+      case POP:  TIMED(v##_pop(&Q, &key)); break;                       \
+      case MIXED:                                                       \
+        TIMED(id = v##_pop(&Q, &key);                                   \
+              v##_push(&Q, key+R[n+i], key+R[n+i], id));                \
+        break;                                                          \
+      }                                                                 \
+    }                                                                   \
+    double const s = (now() - t0) * 1e-9;                               \
+    v##_free(&Q);                                                       \
+    return s;                                                           \
+  }                                                                     \
+                                                                        \
+  static double replay_##v(trace_op *T, int t, int N,                   \
+                           double *lat, int stride, int *m){            \
+    v Q;                                                                \
+    unsigned key = 0;                                                   \
+    v##_init(&Q, t, N);                                                 \
+    *m = 0;                                                             \
+    uint64_t const t0 = now();                                          \
+    for(int i=0; i<t; i++){                                             \
+      if(T[i].id < 0){ TIMED(v##_pop(&Q, &key)); }                      \
+      else TIMED(v##_push(&Q, lround(SCALE*T[i].key), T[i].key, T[i].id));\
+    }                                                                   \
+    double const s = (now() - t0) * 1e-9;                               \
+    v##_free(&Q);                                                       \
+    return s;                                                           \
+  }
+
+RUN(voidp)
+RUN(d2)
+RUN(d4)
+RUN(d8)
+RUN(indexed)
+RUN(radix)
+RUN(dial)
+
+typedef struct {
+  char *name;
+  double (*run)(int, int, unsigned*, double*, int, int*);
+  double (*replay)(trace_op*, int, int, double*, int, int*);
+} variant;
+
+#define VARIANT(v, name) { name, run_##v, replay_##v }
+variant variants[] = {
+  VARIANT(voidp, "heap"),
+  VARIANT(d2, "typed2"),
+  VARIANT(d4, "typed4"),
+  VARIANT(d8, "typed8"),
+  VARIANT(indexed, "iheap"),
+  VARIANT(radix, "rheap"),
+  VARIANT(dial, "bqueue"),
+};
+
+////////////////////////////////////////////////////
+
+static int fcmp_double(const void *x, const void *y){
+  double const a = *(double*)x, b = *(double*)y;
+  return (a<b)? -1 : (a>b);
+}
+
+// Percentile q des m latences de lat[], triées.
+static double percentile(double *lat, int m, double q){
+  if(m == 0) return 0;
+  int i = (int)ceil(q*m) - 1;
+  return lat[(i < 0)? 0 : i];
+}
+
+// Affiche une ligne CSV: durée s pour ops opérations, latences lat[].
+static void report(char *v, char *w, int n, int ops, double s, double *lat, int m){
+  qsort(lat, m, sizeof(double), fcmp_double);
+  printf("%s,%s,%d,%d,%.6f,%.3f,%.0f,%.0f,%.0f\n", v, w, n, ops, s,
+         (s > 0)? ops/s*1e-6 : 0,
+         percentile(lat, m, 0.5), percentile(lat, m, 0.99), percentile(lat, m, 0.999));
+  fflush(stdout);
+}
+
+// Charge le fichier de trace file dans *T et renvoie son nombre
+// d'opérations (-1 si illisible). Écrit dans *N le plus grand id + 1.
+static int load(char *file, trace_op **T, int *N){
+  FILE *f = fopen(file, "rb");
+  if(f == NULL) return -1;
+  int t = 0, size = 1024;
+  *T = malloc(size*sizeof(trace_op));
+  *N = 0;
+  while(fread(*T+t, sizeof(trace_op), 1, f) == 1){
+    if((*T)[t].id >= *N) *N = (*T)[t].id+1;
+    if(++t == size) *T = realloc(*T, (size *= 2)*sizeof(trace_op));
+  }
+  fclose(f);
+  return t;
+}
+
+int main(int argc, char *argv[]){
+  int nmax = (argc >= 2)? (int)atof(argv[1]) : 1000000;
+  int const nv = sizeof(variants)/sizeof(*variants);
+  if(nmax < 1000){
+    printf("\n Usage: %s [nmax] [trace ...]\n", argv[0]);
+    printf("   Ex.: %s 1e6 astar.trace > bench.csv\n\n", argv[0]);
+    printf("    nmax  = largest n, at least 1e3 (default 1e6)\n");
+    printf("    trace = A* open-list trace recorded by a_star.c\n\n");
+    exit(1);
+  }
+
+  unsigned *R = malloc(2*(size_t)nmax*sizeof(unsigned));
+  double *lat = malloc(SAMPLES*sizeof(double));
+  srandom(1);
+  for(long i=0; i<2L*nmax; i++) R[i] = random() % KEYS;
+
+  printf("variant,workload,n,ops,seconds,mops,p50_ns,p99_ns,p999_ns\n");
+  for(long n=1000; n<=nmax; n*=10){
+    int const stride = (n+SAMPLES-1)/SAMPLES;
+    for(int w=PUSH; w<=MIXED; w++)
+      for(int v=0; v<nv; v++){
+        int m;
+        double const s = variants[v].run(w, n, R, NULL, 1, &m);
+        variants[v].run(w, n, R, lat, stride, &m);
+        report(variants[v].name, workload[w], n, n, s, lat, m);
+      }
+  }
+
+  for(int a=2; a<argc; a++){
+    trace_op *T;
+    int N, t = load(argv[a], &T, &N);
+    if(t < 0){
+      fprintf(stderr, "cannot read trace %s\n", argv[a]);
+      continue;
+    }
+    char w[strlen(argv[a]) + 7];
+    sprintf(w, "trace:%s", argv[a]);
+    int const stride = (t+SAMPLES-1)/SAMPLES;
+    for(int v=0; v<nv; v++){
+      int m;
+      double const s = variants[v].replay(T, t, N, NULL, 1, &m);
+      variants[v].replay(T, t, N, lat, stride, &m);
+      report(variants[v].name, w, N, t, s, lat, m);
+    }
+    free(T);
+  }
+
+  free(lat);
+  free(R);
+  return 0;
+}
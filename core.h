@@ -0,0 +1,51 @@
+#ifndef __CORE_H__
+#define __CORE_H__
+
+// Définitions communes aux solveurs, sans dépendance à SDL ni à
+// OpenGL: les fichiers tsp_*.c (sauf tsp_main.c) n'incluent que ce
+// fichier et forment la bibliothèque libtsp.a. L'affichage est dans
+// tools.h.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <sys/time.h>
+#include <limits.h>
+
+
+// échange les variables x et y, via z
+#define SWAP(x, y, z)  (z) = (x), (x) = (y), (y) = (z)
+
+// réel aléatoire dans [0,1]
+#define RAND01  ((double)random()/RAND_MAX)
+
+// taille maximum du nom d'un fichier
+#define MAX_FILE_NAME  256
+
+
+// Un point (x,y).
+typedef struct {
+  double x, y;
+} point;
+
+// Construit la prochaine permutation de P de taille n dans l'ordre
+// lexicographique. Le résultat est écrit dans P. La fonction renvoie
+// true sauf si à l'appel P était la dernière permutation. Dans ce cas
+// false est renvoyé et P n'est pas modifiée. Il n'est pas nécessaire
+// que les valeurs de P soit dans [0,n[.
+bool NextPermutation(int *P, int n);
+
+// Un graphe G (pour MST).
+typedef struct {
+  int n;         // n=nombre de sommets
+  int *deg;      // deg[u]=nombre de voisins du sommet u
+  int **list;    // list[u][i]=i-ème voisin de u, i=0..deg[u]-1
+} graph;
+
+#endif
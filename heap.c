@@ -1,5 +1,6 @@
 #include "heap.h"
 #include <stdlib.h>
+#include <string.h>
 
 heap heap_create(int k, int (*f)(const void *, const void *)) {
   heap h = malloc(sizeof(*h));
@@ -20,8 +21,17 @@ bool heap_empty(heap h) {
   return h->n == 0;
 }
 
+bool heap_reserve(heap h, int k) {
+  if(k <= h->nmax) return false;
+  void* *a = realloc(h->array, (k+1)*sizeof(void*));
+  if(a == NULL) return true;
+  h->array = a;
+  h->nmax = k;
+  return false;
+}
+
 bool heap_add(heap h, void *object) {
-  if(h->n > h->nmax){
+  if(h->n == h->nmax && heap_reserve(h, h->nmax? 2*h->nmax : 4)){
     return true;
   }
 
@@ -75,3 +85,363 @@ void *heap_pop(heap h) {
   }
   return poped;
 }
+
+// Descend l'objet d'indice i jusqu'à sa place.
+static void sift_down_at(heap h, int i) {
+  void *x = h->array[i];
+  for(int j=2*i; j<=h->n; i=j, j=2*i){
+    if(j < h->n && h->f(h->array[j+1], h->array[j]) < 0) j++;
+    if(h->f(h->array[j], x) >= 0) break;
+    h->array[i] = h->array[j];
+  }
+  h->array[i] = x;
+}
+
+// Réordonne array[1..n] en tas, de bas en haut: chaque sous-arbre est
+// un tas une fois ses deux fils traités. Le coût est O(n) car la
+// plupart des noeuds sont proches des feuilles.
+static void heapify(heap h) {
+  for(int i=h->n/2; i>=1; i--) sift_down_at(h, i);
+}
+
+bool heap_build(heap h, void **T, int m) {
+  if(heap_reserve(h, h->n + m)) return true;
+  memcpy(h->array + h->n + 1, T, m*sizeof(void*));
+  h->n += m;
+  heapify(h);
+  return false;
+}
+
+void heap_clear(heap h) {
+  h->n = 0;
+}
+
+void *heap_get(heap h, int i) {
+  return (0 <= i && i < h->n)? h->array[i+1] : NULL;
+}
+
+int heap_drain(heap h, void **T) {
+  int const m = h->n;
+  memcpy(T, h->array + 1, m*sizeof(void*));
+  h->n = 0;
+  return m;
+}
+
+bool heap_meld(heap h, heap g) {
+  int const m = g->n;
+  if(heap_reserve(h, h->n + m)) return true;
+  // m ajouts coûtent m*log(n+m), une reconstruction n+m
+  int lg = 1;
+  while((1 << lg) < h->n + m) lg++;
+  if((long)m*lg < h->n + m)
+    for(int i=1; i<=m; i++) heap_add(h, g->array[i]);
+  else heap_build(h, g->array + 1, m);
+  g->n = 0;
+  return false;
+}
+
+//
+//  MULTIQUEUE
+//
+
+multiqueue mq_create(int p, int c, int k, int (*f)(const void *, const void *)) {
+  multiqueue q = malloc(sizeof(*q));
+  q->m = (p*c < 1)? 1 : p*c;
+  q->shard = aligned_alloc(64, q->m*sizeof(mq_shard));
+  for(int i=0; i<q->m; i++){
+    q->shard[i].h = heap_create(k, f);
+    pthread_mutex_init(&q->shard[i].lock, NULL);
+    atomic_init(&q->shard[i].top, NULL);
+  }
+  q->f = f;
+  atomic_init(&q->n, 0);
+  return q;
+}
+
+void mq_destroy(multiqueue q) {
+  for(int i=0; i<q->m; i++){
+    heap_destroy(q->shard[i].h);
+    pthread_mutex_destroy(&q->shard[i].lock);
+  }
+  free(q->shard);
+  free(q);
+}
+
+mq_handle mq_handle_create(multiqueue q, unsigned seed) {
+  return (mq_handle){ .q = q, .seed = 2*(unsigned long)seed + 1 };
+}
+
+bool mq_empty(multiqueue q) {
+  return atomic_load(&q->n) == 0;
+}
+
+// Indice aléatoire de tas dans [0,m[ (xorshift64).
+static int mq_rand(mq_handle *H) {
+  unsigned long x = H->seed;
+  x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+  H->seed = x;
+  return (int)((x >> 11) % (unsigned long)H->q->m);
+}
+
+bool mq_add(mq_handle *H, void *object) {
+  multiqueue q = H->q;
+  mq_shard *S;
+  do S = &q->shard[mq_rand(H)];
+  while(pthread_mutex_trylock(&S->lock) != 0);
+  bool const full = heap_add(S->h, object);
+  atomic_store(&S->top, heap_top(S->h));
+  pthread_mutex_unlock(&S->lock);
+  if(!full) atomic_fetch_add(&q->n, 1); // compté une fois visible
+  return full;
+}
+
+// Extrait le sommet de S s'il n'est pas vide, sous verrou pris.
+static void *mq_take(multiqueue q, mq_shard *S) {
+  void *x = heap_pop(S->h);
+  atomic_store(&S->top, heap_top(S->h));
+  pthread_mutex_unlock(&S->lock);
+  if(x) atomic_fetch_sub(&q->n, 1);
+  return x;
+}
+
+void *mq_pop(mq_handle *H) {
+  multiqueue q = H->q;
+  for(int fail=0; atomic_load(&q->n) > 0; ){
+    if(fail < 2*q->m){
+      // meilleur de deux tas au hasard, comparés sous leurs verrous:
+      // un sommet lu sans verrou peut être extrait et libéré entre-temps
+      mq_shard *A = &q->shard[mq_rand(H)], *B = &q->shard[mq_rand(H)];
+      if(atomic_load(&A->top) == NULL) A = B;
+      if(atomic_load(&A->top) == NULL || pthread_mutex_trylock(&A->lock) != 0){ fail++; continue; }
+      if(B != A && atomic_load(&B->top) != NULL && pthread_mutex_trylock(&B->lock) == 0){
+        void *a = heap_top(A->h), *b = heap_top(B->h);
+        if(b != NULL && (a == NULL || q->f(b, a) < 0)){ mq_shard *t = A; A = B, B = t; }
+        pthread_mutex_unlock(&B->lock);
+      }
+      void *x = mq_take(q, A);
+      if(x) return x;
+      fail++;
+    }else{
+      // peu d'objets pour beaucoup de tas: on les parcourt tous, en
+      // sautant ceux qui sont pris
+      for(int i=0; i<q->m; i++){
+        mq_shard *S = &q->shard[i];
+        if(atomic_load(&S->top) == NULL || pthread_mutex_trylock(&S->lock) != 0) continue;
+        void *x = mq_take(q, S);
+        if(x) return x;
+      }
+      fail = 0;
+    }
+  }
+  return NULL;
+}
+
+//
+//  TAS INDEXÉ
+//
+
+iheap iheap_create(int N) {
+  iheap h = malloc(sizeof(*h));
+  h->array = malloc((N+1)*sizeof(int));
+  h->pos = calloc(N, sizeof(int));
+  h->key = malloc(N*sizeof(double));
+  h->n = 0;
+  h->N = N;
+  return h;
+}
+
+void iheap_destroy(iheap h) {
+  free(h->key);
+  free(h->pos);
+  free(h->array);
+  free(h);
+}
+
+bool iheap_empty(iheap h) {
+  return h->n == 0;
+}
+
+bool iheap_contains(iheap h, int id) {
+  return h->pos[id] > 0;
+}
+
+// Place id à l'indice i (un trou) puis le remonte.
+static void sift_up(iheap h, int i, int id) {
+  double const k = h->key[id];
+  while(i > 1 && k < h->key[h->array[i/2]]){
+    h->array[i] = h->array[i/2];
+    h->pos[h->array[i]] = i;
+    i /= 2;
+  }
+  h->array[i] = id;
+  h->pos[id] = i;
+}
+
+// Place id à l'indice i (un trou) puis le descend.
+static void sift_down(iheap h, int i, int id) {
+  double const k = h->key[id];
+  for(int j=2*i; j<=h->n; i=j, j=2*i){
+    if(j < h->n && h->key[h->array[j+1]] < h->key[h->array[j]]) j++;
+    if(h->key[h->array[j]] >= k) break;
+    h->array[i] = h->array[j];
+    h->pos[h->array[i]] = i;
+  }
+  h->array[i] = id;
+  h->pos[id] = i;
+}
+
+void iheap_add(iheap h, int id, double key) {
+  h->key[id] = key;
+  sift_up(h, ++h->n, id);
+}
+
+bool iheap_decrease_key(iheap h, int id, double key) {
+  if(!iheap_contains(h, id)){
+    iheap_add(h, id, key);
+    return true;
+  }
+  if(key >= h->key[id]) return false;
+  h->key[id] = key;
+  sift_up(h, h->pos[id], id);
+  return true;
+}
+
+void iheap_remove(iheap h, int id) {
+  int const i = h->pos[id];
+  if(i == 0) return;
+  h->pos[id] = 0;
+  int const last = h->array[h->n--];
+  if(last == id) return;
+  // last prend la place de id: il peut monter ou descendre
+  if(i > 1 && h->key[last] < h->key[h->array[i/2]]) sift_up(h, i, last);
+  else sift_down(h, i, last);
+}
+
+int iheap_top(iheap h) {
+  return (h->n == 0)? -1 : h->array[1];
+}
+
+int iheap_pop(iheap h) {
+  int const id = iheap_top(h);
+  if(id >= 0) iheap_remove(h, id);
+  return id;
+}
+
+//
+//  FILES MONOTONES
+//
+
+// Ajoute (key,id) au seau B, en doublant sa taille si besoin. Les
+// clés ne sont stockées que si radix=true.
+static void bucket_push(bucket *B, unsigned key, int id, bool radix) {
+  if(B->n == B->nmax){
+    B->nmax = B->nmax? 2*B->nmax : 4;
+    B->id = realloc(B->id, B->nmax*sizeof(int));
+    if(radix) B->key = realloc(B->key, B->nmax*sizeof(unsigned));
+  }
+  if(radix) B->key[B->n] = key;
+  B->id[B->n++] = id;
+}
+
+static void bucket_free(bucket *B) {
+  free(B->id);
+  free(B->key);
+}
+
+// Seau de la clé k pour la dernière clé extraite last: le nombre de
+// bits de k^last.
+static inline int radix(unsigned k, unsigned last) {
+  unsigned const x = k ^ last;
+  return x? 32 - __builtin_clz(x) : 0;
+}
+
+rheap rheap_create(void) {
+  rheap h = calloc(1, sizeof(*h));
+  return h;
+}
+
+void rheap_destroy(rheap h) {
+  for(int b=0; b<=32; b++) bucket_free(&h->b[b]);
+  free(h);
+}
+
+bool rheap_empty(rheap h) {
+  return h->n == 0;
+}
+
+void rheap_add(rheap h, unsigned key, int id) {
+  if(key < h->last) key = h->last;
+  bucket_push(&h->b[radix(key, h->last)], key, id, true);
+  h->n++;
+}
+
+int rheap_pop(rheap h, unsigned *key) {
+  if(h->n == 0) return -1;
+  if(h->b[0].n == 0){
+    // premier seau non vide, son minimum devient last, puis on le
+    // redistribue: ses clés ont toutes un seau < b pour ce last
+    int b = 1;
+    while(h->b[b].n == 0) b++;
+    bucket *B = &h->b[b];
+    unsigned m = B->key[0];
+    for(int i=1; i<B->n; i++) if(B->key[i] < m) m = B->key[i];
+    h->last = m;
+    for(int i=0; i<B->n; i++)
+      bucket_push(&h->b[radix(B->key[i], m)], B->key[i], B->id[i], true);
+    B->n = 0;
+  }
+  h->n--;
+  if(key) *key = h->last;
+  return h->b[0].id[--h->b[0].n];
+}
+
+bqueue bqueue_create(int R) {
+  if(R < 1) R = 1; // sinon bqueue_grow() doublerait 0 indéfiniment
+  bqueue q = malloc(sizeof(*q));
+  q->b = calloc(R, sizeof(bucket));
+  q->R = R;
+  q->last = 0;
+  q->n = 0;
+  return q;
+}
+
+void bqueue_destroy(bqueue q) {
+  for(int b=0; b<q->R; b++) bucket_free(&q->b[b]);
+  free(q->b);
+  free(q);
+}
+
+bool bqueue_empty(bqueue q) {
+  return q->n == 0;
+}
+
+// Double le nombre de seaux de q. La clé des ids du seau b est
+// l'unique k de [last, last+R[ tel que k%R = b, et ces R clés tombent
+// dans des seaux k%2R distincts: chaque seau est déplacé tel quel.
+static void bqueue_grow(bqueue q) {
+  int const R = q->R;
+  bucket *old = q->b;
+  q->b = calloc(2*R, sizeof(bucket));
+  q->R = 2*R;
+  for(int b=0; b<R; b++){
+    unsigned const k = q->last + (b + R - q->last%R) % R;
+    q->b[k % q->R] = old[b];
+  }
+  free(old);
+}
+
+void bqueue_add(bqueue q, unsigned key, int id) {
+  if(key < q->last) key = q->last;
+  while(key - q->last >= (unsigned)q->R) bqueue_grow(q);
+  bucket_push(&q->b[key % q->R], key, id, false);
+  q->n++;
+}
+
+int bqueue_pop(bqueue q, unsigned *key) {
+  if(q->n == 0) return -1;
+  bucket *B;
+  while((B = &q->b[q->last % q->R])->n == 0) q->last++;
+  q->n--;
+  if(key) *key = q->last;
+  return B->id[--B->n];
+}
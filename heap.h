@@ -1,12 +1,16 @@
 #ifndef HEAP_H
 #define HEAP_H
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
 // Structure de tas binaire:
 //
 //  array = tableau de stockage des objets à partir de l'indice 1 (au lieu de 0)
 //  n     = nombre d'objets (qui sont des void*) stockés dans le tas
-//  nmax  = nombre maximum d'objets stockables dans le tas
+//  nmax  = nombre d'objets stockables dans array sans l'agrandir
 //  f     = fonction de comparaison de deux objets (min, max, ..., cf. man qsort)
 //
 // Attention ! "heap" est défini comme un pointeur pour optimiser les
@@ -19,8 +23,10 @@ typedef struct{
 } *heap;
 
 
-// Crée un tas pouvant accueillir au plus k>0 objets avec une fonction
-// de comparaison f() prédéfinie. NB: La taille d'un objet pointé par
+// Crée un tas avec une fonction de comparaison f() prédéfinie, de
+// place initiale pour k objets. Le tableau double de taille lorsqu'il
+// est plein: k n'est qu'une indication, et la mémoire reste
+// proportionnelle au nombre d'objets effectivement présents. NB: La taille d'un objet pointé par
 // un pointeur h est sizeof(*h). Par exemple, si on déclare une
 // variable T comme "double * T;" alors T est une variable de type
 // "double*" (avec sizeof(T)=4) et *T est une variable de type
@@ -39,8 +45,9 @@ void heap_destroy(heap h);
 bool heap_empty(heap h);
 
 
-// Ajoute un objet au tas h. On supposera h!=NULL. Renvoie vrai s'il
-// n'y a pas assez de place, et faux sinon.
+// Ajoute un objet au tas h, en doublant la taille du tableau si h est
+// plein. On supposera h!=NULL. Renvoie vrai s'il n'y a pas assez de
+// mémoire, et faux sinon.
 bool heap_add(heap h, void *object);
 
 
@@ -54,4 +61,402 @@ void *heap_top(heap h);
 // tas. Renvoie NULL si le tas est vide.
 void *heap_pop(heap h);
 
+
+// Agrandit si besoin le tableau de h pour qu'il puisse contenir k
+// objets sans réallocation. Renvoie vrai s'il n'y a pas assez de
+// mémoire, et faux sinon.
+bool heap_reserve(heap h, int k);
+
+
+// Ajoute les m objets T[0..m-1] au tas h en une seule fois, en
+// reconstruisant le tas de bas en haut en O(n+m) au lieu de m appels
+// à heap_add() en O(m*log(n+m)). Renvoie vrai s'il n'y a pas assez de
+// mémoire, et faux sinon.
+bool heap_build(heap h, void **T, int m);
+
+
+// Vide le tas h sans libérer son tableau, pour le réutiliser.
+void heap_clear(heap h);
+
+
+// Renvoie l'objet numéro i du tableau de h, 0<=i<n, sans modifier le
+// tas, ou NULL si i n'est pas un indice valide. Les objets ne sont
+// pas triés: seul l'objet numéro 0 est le minimum.
+void *heap_get(heap h, int i);
+
+
+// Copie les n objets de h dans T (dans l'ordre du tableau, pas triés),
+// vide le tas et renvoie n. Il faut T de taille au moins n.
+int heap_drain(heap h, void **T);
+
+
+// Déplace tous les objets du tas g dans le tas h, qui doivent avoir la
+// même fonction de comparaison. Le tas g est vidé mais pas détruit.
+// Renvoie vrai s'il n'y a pas assez de mémoire (h et g sont alors
+// inchangés), et faux sinon.
+bool heap_meld(heap h, heap g);
+
+
+// File de priorité concurrente relâchée (MultiQueue): m = c*p tas
+// (c tas par thread pour p threads), chacun protégé par son verrou.
+// Un ajout va dans un tas au hasard, et une extraction prend le
+// meilleur des sommets de deux tas tirés au hasard. Les threads ne se
+// bloquent jamais sur un même verrou (pthread_mutex_trylock(): si le
+// tas est pris, on en tire un autre), si bien que le débit croît avec
+// p au lieu d'être limité par un verrou global. En contrepartie l'ordre
+// n'est que approximatif: l'objet extrait est parmi les O(m) meilleurs
+// en moyenne, ce qui suffit pour une recherche en meilleur d'abord
+// parallèle (qui doit de toute façon accepter qu'un sommet soit
+// extrait avant d'être définitif). Avec m=1 c'est un tas ordinaire.
+//
+// Chaque thread accède à la file par son propre mq_handle, qui porte
+// son générateur aléatoire: aucune donnée n'est partagée pour les
+// tirages. Les sommets des tas sont publiés dans top, qui ne sert qu'à
+// savoir sans verrou si un tas est vide: il n'est jamais déréférencé,
+// et les deux sommets sont comparés avec les deux verrous pris. Un
+// objet extrait peut donc être libéré aussitôt.
+//
+//  shard = les m tas, chacun aligné sur une ligne de cache
+//  m     = nombre de tas
+//  n     = nombre d'objets dans la file
+
+typedef struct{
+  _Alignas(64) heap h;
+  pthread_mutex_t lock;
+  _Atomic(void*) top; // sommet de h, NULL si h est vide (indication)
+} mq_shard;
+
+typedef struct{
+  mq_shard *shard;
+  int m;
+  int (*f)(const void*, const void*);
+  atomic_int n;
+} *multiqueue;
+
+typedef struct{
+  multiqueue q;
+  unsigned long seed;
+} mq_handle;
+
+
+// Crée une file de c*p tas vides de comparaison f(), chacun de place
+// initiale k (cf. heap_create()).
+multiqueue mq_create(int p, int c, int k, int (*f)(const void *, const void *));
+
+
+// Détruit la file q. Aucun thread ne doit plus l'utiliser.
+void mq_destroy(multiqueue q);
+
+
+// Renvoie un accès à q pour un thread, de générateur initialisé par
+// seed (qui doit être différent pour chaque thread).
+mq_handle mq_handle_create(multiqueue q, unsigned seed);
+
+
+// Renvoie vrai si la file est vide. Avec des ajouts concurrents, ce
+// n'est qu'une indication.
+bool mq_empty(multiqueue q);
+
+
+// Ajoute un objet à la file par l'accès H. Renvoie vrai s'il n'y a pas
+// assez de mémoire, et faux sinon.
+bool mq_add(mq_handle *H, void *object);
+
+
+// Supprime et renvoie un objet presque minimal de la file par l'accès
+// H, ou NULL si la file est vide.
+void *mq_pop(mq_handle *H);
+
+
+// Tas indexé: tas min d'identifiants entiers id∈[0,N[ selon leur clé
+// key[id]. Chaque id est au plus une fois dans le tas, et sa position
+// pos[id] dans le tableau est tenue à jour, ce qui permet de diminuer
+// sa clé ou de le supprimer sans gestion paresseuse: le tas ne
+// contient jamais plus de N objets.
+//
+//  array = les ids, à partir de l'indice 1
+//  pos   = pos[id] = indice de id dans array, 0 si id n'est pas dans le tas
+//  key   = key[id] = clé de id, valide seulement si id est dans le tas
+//  n     = nombre d'ids dans le tas
+//  N     = nombre d'ids possibles
+
+typedef struct{
+  int *array;
+  int *pos;
+  double *key;
+  int n, N;
+} *iheap;
+
+
+// Crée un tas indexé vide pour les ids de [0,N[.
+iheap iheap_create(int N);
+
+
+// Détruit le tas h.
+void iheap_destroy(iheap h);
+
+
+// Renvoie vrai si le tas h est vide, faux sinon.
+bool iheap_empty(iheap h);
+
+
+// Renvoie vrai si id est dans le tas h.
+bool iheap_contains(iheap h, int id);
+
+
+// Ajoute id, qui ne doit pas être dans h, avec la clé key.
+void iheap_add(iheap h, int id, double key);
+
+
+// Diminue à key la clé de id. Si id n'est pas dans h, il est ajouté.
+// Renvoie faux, sans rien modifier, si id est dans h avec une clé
+// inférieure ou égale à key.
+bool iheap_decrease_key(iheap h, int id, double key);
+
+
+// Supprime id du tas h, s'il y est.
+void iheap_remove(iheap h, int id);
+
+
+// Renvoie l'id de clé minimum, sans le supprimer, ou -1 si h est vide.
+int iheap_top(iheap h);
+
+
+// Comme iheap_top() sauf que l'id est en plus supprimé du tas.
+int iheap_pop(iheap h);
+
+
+// Files monotones: files de priorité d'ids entiers de clés entières
+// (unsigned) où la clé ajoutée n'est jamais inférieure à la dernière
+// clé extraite, comme pour Dijkstra ou A* avec une heuristique
+// monotone lorsque les coûts sont ramenés à des entiers. Ajouts et
+// extractions se font alors sans comparaisons de tas. Une clé ajoutée
+// inférieure à la dernière clé extraite (heuristique non monotone) est
+// remplacée par celle-ci. Comme pour le tas de A_star(), un id peut y
+// être plusieurs fois (gestion paresseuse).
+//
+// La file radix (rheap) range la clé k dans le seau b = nombre de bits
+// de k^last, où last est la dernière clé extraite: le seau 0 contient
+// les clés égales à last, et le seau b les clés qui diffèrent de last
+// à partir du bit b-1. Pour extraire, on vide le premier seau non vide
+// b>0 dans les seaux inférieurs après avoir pris son minimum pour
+// last. Une clé ne peut que descendre de seau, d'où un coût amorti en
+// O(log C) par clé, où C est le plus grand écart entre clés.
+//
+// La file de Dial (bqueue) suppose de plus que les clés présentes sont
+// dans [last, last+R[: elle range la clé k dans le seau k%R
+// d'un tableau circulaire de R seaux, et les clés sortent en avançant
+// last, d'où un coût amorti en O(1) par clé (plus O(1) par valeur de
+// clé sautée). Pour A*, R doit dépasser le plus grand écart entre la
+// clé d'un sommet et celle d'un voisin (poids maximum + variation
+// maximum de l'heuristique), sinon R est doublé lors de l'ajout.
+
+typedef struct{
+  int *id;          // ids du seau
+  unsigned *key;    // clés des ids (file radix seulement)
+  int n, nmax;
+} bucket;
+
+typedef struct{
+  bucket b[33]; // seaux 0..32
+  unsigned last;
+  int n;
+} *rheap;
+
+typedef struct{
+  bucket *b; // b[0..R-1]
+  int R;
+  unsigned last;
+  int n;
+} *bqueue;
+
+
+// Crée une file radix vide, de dernière clé 0.
+rheap rheap_create(void);
+
+
+// Détruit la file h.
+void rheap_destroy(rheap h);
+
+
+// Renvoie vrai si la file h est vide.
+bool rheap_empty(rheap h);
+
+
+// Ajoute id avec la clé key.
+void rheap_add(rheap h, unsigned key, int id);
+
+
+// Extrait un id de clé minimum, écrit sa clé dans *key (si non NULL)
+// et le renvoie, ou renvoie -1 si h est vide.
+int rheap_pop(rheap h, unsigned *key);
+
+
+// Crée une file de Dial vide de R seaux, de dernière clé 0. Il faut
+// R>=1 (R<1 est ramené à 1), puisque R est doublé quand une clé
+// dépasse last+R.
+bqueue bqueue_create(int R);
+
+// Détruit la file q.
+void bqueue_destroy(bqueue q);
+
+
+// Renvoie vrai si la file q est vide.
+bool bqueue_empty(bqueue q);
+
+
+// Ajoute id avec la clé key. Si key ≥ last+R, le nombre R de seaux
+// est doublé autant que nécessaire.
+void bqueue_add(bqueue q, unsigned key, int id);
+
+
+// Comme rheap_pop().
+int bqueue_pop(bqueue q, unsigned *key);
+
+
+// Tas typés.
+//
+// HEAP_DEFINE(name, K, T, less) définit le type heap_name d'un tas
+// binaire de paires (clé de type K, valeur de type T) rangées
+// directement dans le tableau, au lieu de pointeurs void*: lire une
+// clé ne demande pas d'indirection, et la comparaison less(a,b) (vrai
+// ssi la clé a doit sortir avant la clé b) est développée sur place au
+// lieu d'un appel par pointeur de fonction. Les fonctions sont celles
+// de heap, préfixées par heap_name:
+//
+//   heap_name heap_name_create(int k); // NULL si plus de mémoire
+//   void heap_name_destroy(heap_name h);
+//   bool heap_name_empty(heap_name h);
+//   bool heap_name_reserve(heap_name h, int k); // vrai si plus de mémoire
+//   void heap_name_clear(heap_name h);
+//   bool heap_name_add(heap_name h, K key, T val); // vrai si plus de mémoire
+//   bool heap_name_top(heap_name h, K *key, T *val); // faux si vide
+//   bool heap_name_pop(heap_name h, K *key, T *val); // faux si vide
+//
+// top() et pop() écrivent la clé et la valeur du sommet dans *key et
+// *val (si non NULL). Comme pour heap, k n'est que la place initiale:
+// add() double la taille du tableau quand il est plein. Exemple, un
+// tas min d'indices par distance:
+//
+//   HEAP_DEFINE(dist, double, int, HEAP_MIN)
+//   heap_dist Q = heap_dist_create(n);
+//   heap_dist_add(Q, d, u);
+//   while (heap_dist_pop(Q, &d, &u)) { ... }
+//
+// HEAP_DEFINE_ARY(name, K, T, less, D) définit de la même façon un
+// tas d-aire, où chaque noeud a D fils au lieu de 2. La hauteur est
+// divisée par log2(D), et les D fils d'un noeud sont consécutifs:
+// le tableau est aligné sur HEAP_ALIGN octets et décalé de sorte que
+// chaque groupe de fils commence sur une ligne de cache. Si D paires
+// occupent exactement une ligne (D=4 pour une clé double et une valeur
+// pointeur, 16 octets), chaque niveau de la descente de pop() ne coûte
+// qu'un défaut de cache, contre un par niveau pour le tas binaire dès
+// qu'il ne tient plus en cache. Le fils minimum est cherché sans
+// branchement, par sélection. HEAP_DEFINE() est le cas D=2.
+//
+// Les indices restent à partir de 1: les fils de i sont D*(i-1)+2 à
+// D*i+1, et son père est (i-2)/D+1. Pour D=2 on retrouve 2i, 2i+1 et
+// i/2.
+
+#define HEAP_MIN(a, b) ((a) < (b))
+#define HEAP_MAX(a, b) ((a) > (b))
+#define HEAP_ALIGN 64 // taille d'une ligne de cache
+
+#define HEAP_DEFINE(name, K, T, less) HEAP_DEFINE_ARY(name, K, T, less, 2)
+
+#define HEAP_DEFINE_ARY(name, K, T, less, D)                            \
+  typedef struct { K key; T val; } heap_##name##_item;                  \
+  typedef struct {                                                      \
+    heap_##name##_item *array; /* array[1..n], dans mem[] */            \
+    heap_##name##_item *mem;   /* zone allouée, alignée */              \
+    int n, nmax;                                                        \
+  } *heap_##name;                                                       \
+                                                                        \
+  static inline bool heap_##name##_reserve(heap_##name h, int k) {     \
+    if (k <= h->nmax) return false;                                     \
+    size_t m = (k+D) * sizeof(heap_##name##_item);                      \
+    m = (m + HEAP_ALIGN-1) / HEAP_ALIGN * HEAP_ALIGN;                   \
+    heap_##name##_item *mem = aligned_alloc(HEAP_ALIGN, m);             \
+    if (mem == NULL) return true;                                       \
+    if (h->n > 0) memcpy(mem, h->mem, (h->n+D-1) * sizeof(*mem));       \
+    free(h->mem);                                                       \
+    h->mem = mem;                                                       \
+    h->array = mem + (D-2); /* array[D*(i-1)+2] = mem[D*i] */           \
+    h->nmax = k;                                                        \
+    return false;                                                       \
+  }                                                                     \
+                                                                        \
+  static inline heap_##name heap_##name##_create(int k) {               \
+    heap_##name h = malloc(sizeof(*h));                                 \
+    if (h == NULL) return NULL;                                         \
+    h->array = h->mem = NULL;                                           \
+    h->n = h->nmax = 0;                                                 \
+    if (heap_##name##_reserve(h, (k < 1)? 1 : k)) {                     \
+      free(h);                                                          \
+      return NULL;                                                      \
+    }                                                                   \
+    return h;                                                           \
+  }                                                                     \
+                                                                        \
+  static inline void heap_##name##_clear(heap_##name h) {               \
+    h->n = 0;                                                           \
+  }                                                                     \
+                                                                        \
+  static inline void heap_##name##_destroy(heap_##name h) {             \
+    free(h->mem);                                                       \
+    free(h);                                                            \
+  }                                                                     \
+                                                                        \
+  static inline bool heap_##name##_empty(heap_##name h) {               \
+    return h->n == 0;                                                   \
+  }                                                                     \
+                                                                        \
+  static inline bool heap_##name##_add(heap_##name h, K key, T val) {   \
+    if (h->n == h->nmax && heap_##name##_reserve(h, 2*h->nmax))         \
+      return true;                                                      \
+    heap_##name##_item *a = h->array;                                   \
+    int i = ++h->n; /* le trou remonte jusqu'à la place de key */       \
+    while (i > 1) {                                                     \
+      int const p = (i-2)/D + 1;                                        \
+      if (!less(key, a[p].key)) break;                                  \
+      a[i] = a[p];                                                      \
+      i = p;                                                            \
+    }                                                                   \
+    a[i] = (heap_##name##_item){ key, val };                            \
+    return false;                                                       \
+  }                                                                     \
+                                                                        \
+  static inline bool heap_##name##_top(heap_##name h, K *key, T *val) { \
+    if (h->n == 0) return false;                                        \
+    if (key) *key = h->array[1].key;                                    \
+    if (val) *val = h->array[1].val;                                    \
+    return true;                                                        \
+  }                                                                     \
+                                                                        \
+  static inline bool heap_##name##_pop(heap_##name h, K *key, T *val) { \
+    if (!heap_##name##_top(h, key, val)) return false;                  \
+    heap_##name##_item *a = h->array;                                   \
+    heap_##name##_item const x = a[h->n--]; /* dernier, à replacer */   \
+    int const n = h->n;                                                 \
+    int i = 1; /* le trou descend depuis la racine */                   \
+    for (int j; (j = D*(i-1) + 2) <= n; i = j) {                        \
+      if (j+D-1 <= n) { /* D fils: recherche du minimum sans branche */ \
+        K k = a[j].key;                                                 \
+        int m = j;                                                      \
+        for (int c = 1; c < D; c++) {                                   \
+          bool const b = less(a[j+c].key, k);                           \
+          k = b? a[j+c].key : k;                                        \
+          m = b? j+c : m;                                               \
+        }                                                               \
+        j = m;                                                          \
+      } else /* dernier groupe, incomplet */                            \
+        for (int c = j+1; c <= n; c++)                                  \
+          if (less(a[c].key, a[j].key)) j = c;                          \
+      if (!less(a[j].key, x.key)) break;                                \
+      a[i] = a[j];                                                      \
+    }                                                                   \
+    a[i] = x;                                                           \
+    return true;                                                        \
+  }
+
 #endif
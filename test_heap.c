@@ -30,6 +30,7 @@
 #include <time.h>
 #include <string.h>
 #include <unistd.h>
+#include <float.h>
 
 #define BAR "-"  // un tiret
 #define MAXSTR 7 // taille max d'une string
@@ -40,6 +41,11 @@ typedef int (*fcmp)(const void*,const void*); // type fonction de comparaison
 typedef char* string;                         // type chaîne de caractères
 typedef struct{ double x,y; } point;          // type point du plan
 
+// tas typés (cf. HEAP_DEFINE() dans heap.h): clé, et indice dans T[]
+// (tas 4-aire pour les int, binaire pour les double)
+HEAP_DEFINE_ARY(int, int, int, HEAP_MIN, 4)
+HEAP_DEFINE(double, double, int, HEAP_MIN)
+
 ////////////////////////////////////////////////////
 
 int fcmp_int(const void *x, const void *y) {
@@ -270,6 +276,30 @@ void print_heap(heap h, int t) {
 
 ////////////////////////////////////////////////////
 
+// Un thread du test de la MultiQueue: ajoute les objets P[i] pour i≡k
+// mod p, puis extrait des objets jusqu'à ce que la file soit vide, en
+// comptant dans seen[] combien de fois chacun sort.
+typedef struct{
+  multiqueue q;
+  void **P;
+  int n, k, p;
+  void *base;     // T[], pour retrouver l'indice d'un objet
+  int size;       // taille d'un objet
+  atomic_int *seen;
+} mq_test;
+
+void *mq_thread(void *arg){
+  mq_test *A = arg;
+  mq_handle H = mq_handle_create(A->q, A->k+1);
+  for(int i=A->k; i<A->n; i+=A->p) mq_add(&H, A->P[i]);
+  void *x;
+  while((x = mq_pop(&H)) || !mq_empty(A->q))
+    if(x) atomic_fetch_add(&A->seen[((char*)x-(char*)A->base)/A->size], 1);
+  return NULL;
+}
+
+////////////////////////////////////////////////////
+
 // NB: s'il y a des fflush(stdout), c'est qu'en cas d'erreur
 // ("segmentation fault" par exemple) il arrive le printf() précédant
 // l'erreur n'a pas le temps d'être affiché (et donc ne s'affiche
@@ -478,6 +508,165 @@ int main(int argc, char *argv[]) {
 	 r? "success!" : FAIL, r?"":"not ");
   fflush(stdout);
 
+  // opérations groupées: h1 (place initiale 1) reçoit la première
+  // moitié de T[] par heap_build() et h2 (place 0) la seconde par
+  // heap_add(), puis heap_meld(h1,h2). Après heap_drain(), h1 est
+  // reconstruit sans T[0] qui est ajouté par un second heap_meld().
+  // Les objets doivent sortir dans l'ordre de S[]. (Pas pour double2,
+  // dont l'ordre n'est pas bien défini.)
+  if(t!=DOUBLE2){
+    printf("testing heap_build, heap_meld, heap_get, heap_drain... ");
+    fflush(stdout);
+    void **P = malloc(n*sizeof(void*));
+    for(i=0; i<n; i++) P[i] = T+i*size[t];
+    heap h1 = heap_create(1, cmp[t]), h2 = heap_create(0, cmp[t]);
+    r = !heap_build(h1, P, n/2);
+    for(i=n/2; i<n; i++) r = r && !heap_add(h2, P[i]);
+    r = r && !heap_meld(h1, h2) && heap_empty(h2) && h1->n==n;
+    for(i=0; i<n; i++) r = r && heap_get(h1, i)!=NULL;
+    r = r && heap_get(h1, n)==NULL && heap_get(h1, -1)==NULL;
+    r = r && heap_drain(h1, P)==n && heap_empty(h1);
+    for(i=0; i<n; i++) P[i] = T+i*size[t]; // ordre de T[]
+    if(n>0){
+      r = r && !heap_build(h1, P+1, n-1) && !heap_add(h2, P[0]);
+      r = r && !heap_meld(h1, h2) && heap_empty(h2);
+    }
+    for(i=0; i<n && r; i++) r = (cmp[t](heap_pop(h1), S+i*size[t]) == 0);
+    r = r && heap_empty(h1);
+    heap_add(h1, T), heap_clear(h1);
+    r = r && heap_empty(h1);
+    heap_destroy(h1);
+    heap_destroy(h2);
+    free(P);
+    printf("%s\n\n", r? "success!" : FAIL);
+    fflush(stdout);
+  }
+
+  // MultiQueue: avec un seul tas, les objets doivent sortir dans
+  // l'ordre de S[]. Avec 4 threads et 2 tas par thread, chaque objet
+  // doit sortir exactement une fois.
+  if(t!=DOUBLE2){
+    printf("testing multiqueue mq_add, mq_pop... ");
+    fflush(stdout);
+    multiqueue q = mq_create(1, 1, 1, cmp[t]);
+    mq_handle H = mq_handle_create(q, 1);
+    for(i=0; i<n; i++) mq_add(&H, T+i*size[t]);
+    for(i=0, r=1; i<n && r; i++) r = (cmp[t](mq_pop(&H), S+i*size[t]) == 0);
+    r = r && mq_pop(&H)==NULL && mq_empty(q);
+    mq_destroy(q);
+
+    enum{ p=4 };
+    void **P = malloc(n*sizeof(void*));
+    atomic_int *seen = calloc(n, sizeof(atomic_int));
+    for(i=0; i<n; i++) P[i] = T+i*size[t];
+    q = mq_create(p, 2, 1, cmp[t]);
+    pthread_t th[p];
+    mq_test A[p];
+    for(int k=0; k<p; k++){
+      A[k] = (mq_test){ q, P, n, k, p, T, size[t], seen };
+      pthread_create(&th[k], NULL, mq_thread, &A[k]);
+    }
+    for(int k=0; k<p; k++) pthread_join(th[k], NULL);
+    for(i=0; i<n; i++) r = r && (atomic_load(&seen[i]) == 1);
+    r = r && mq_empty(q);
+    mq_destroy(q);
+    free(seen);
+    free(P);
+    printf("%s\n\n", r? "success!" : FAIL);
+    fflush(stdout);
+  }
+
+  // même test avec le tas typé, pour les types int et double: les
+  // clés doivent sortir dans le même ordre que S[], et la valeur
+  // associée à chaque clé doit être l'indice d'un élément de T[] égal
+  if(t==INT || t==DOUBLE){
+    printf("testing typed heap heap_%s... ",type[2*t]);
+    fflush(stdout);
+    heap_int hi = heap_int_create(n);
+    heap_double hd = heap_double_create(n);
+    for(i=0; i<n; i++)
+      if( (t==INT)? heap_int_add(hi, ((int*)T)[i], i)
+                  : heap_double_add(hd, ((double*)T)[i], i) ) break;
+    r = (i==n);
+    for(i=0; i<n && r; i++){
+      int k;
+      if(t==INT){
+        int x;
+        r = heap_int_pop(hi, &x, &k) && x==((int*)S)[i] && x==((int*)T)[k];
+      }else{
+        double x;
+        r = heap_double_pop(hd, &x, &k) && x==((double*)S)[i] && x==((double*)T)[k];
+      }
+    }
+    r = r && heap_int_empty(hi) && heap_double_empty(hd);
+    heap_int_destroy(hi);
+    heap_double_destroy(hd);
+    printf("%s\n\n", r? "success!" : FAIL);
+    fflush(stdout);
+
+    // tas indexé: les ids i sont ajoutés avec la clé T[i]+1, puis les
+    // ids pairs sont diminués à T[i] et ceux ≡1 mod 3 supprimés. Les
+    // ids restants doivent sortir une seule fois, par clé croissante.
+    printf("testing indexed heap iheap... ");
+    fflush(stdout);
+    double *key = malloc(n*sizeof(double));
+    iheap q = iheap_create(n);
+    for(i=0; i<n; i++){
+      key[i] = (t==INT)? ((int*)T)[i] : ((double*)T)[i];
+      iheap_add(q, i, key[i]+1);
+    }
+    r = 1;
+    for(i=0; i<n; i++){
+      if(i%2==0) r = r && iheap_decrease_key(q, i, key[i]);
+      else key[i] += 1, r = r && !iheap_decrease_key(q, i, key[i]+1);
+    }
+    int m = n;
+    for(i=1; i<n; i+=3) iheap_remove(q, i), m--;
+    for(i=0; i<n; i++) r = r && (iheap_contains(q, i) == (i%3 != 1));
+    double last = -DBL_MAX;
+    for(int j; (j = iheap_pop(q)) >= 0; m--){
+      r = r && j%3 != 1 && key[j] >= last && !iheap_contains(q, j);
+      last = key[j];
+    }
+    r = r && m==0 && iheap_empty(q);
+    iheap_destroy(q);
+    free(key);
+    printf("%s\n\n", r? "success!" : FAIL);
+    fflush(stdout);
+  }
+
+  // files monotones, pour les int: on extrait un id sur deux, en
+  // ajoutant avant chaque extraction un id de clé last+T[i], et toutes
+  // les clés doivent sortir par ordre croissant. La file de Dial est
+  // créée avec R=0 (ramené à 1), pour tester le doublement des seaux.
+  if(t==INT){
+    printf("testing monotone queues rheap & bqueue... ");
+    fflush(stdout);
+    rheap rh = rheap_create();
+    bqueue bq = bqueue_create(0);
+    unsigned k1 = 0, k2 = 0, l1 = 0, l2 = 0;
+    int m = 0;
+    r = 1;
+    for(i=0; i<n; i++){
+      rheap_add(rh, l1 + ((int*)T)[i], i);
+      bqueue_add(bq, l2 + ((int*)T)[i], i);
+      if(i%2) continue;
+      r = r && rheap_pop(rh, &k1) >= 0 && bqueue_pop(bq, &k2) >= 0;
+      r = r && k1 >= l1 && k2 >= l2 && k1 == k2;
+      l1 = k1, l2 = k2, m++;
+    }
+    for(; !rheap_empty(rh); m++){
+      r = r && rheap_pop(rh, &k1) >= 0 && bqueue_pop(bq, &k2) >= 0;
+      r = r && k1 >= l1 && k2 >= l2 && k1 == k2;
+      l1 = k1, l2 = k2;
+    }
+    r = r && m==n && bqueue_empty(bq) && rheap_pop(rh, NULL) < 0;
+    rheap_destroy(rh);
+    bqueue_destroy(bq);
+    printf("%s\n\n", r? "success!" : FAIL);
+    fflush(stdout);
+  }
+
  fin:;
   // libération de la mémoire
   if(t==STRING) // cas d'un tableau de string
@@ -325,15 +325,19 @@ static grid allocGrid(int x, int y) {
   if (y < 3) y = 3;
   G.X = x;
   G.Y = y;
+  G.cell = malloc(x * y * sizeof(*(G.cell)));
+  G.flag = malloc(x * y * sizeof(*(G.flag)));
+  G.nbr = calloc(x * y, sizeof(*(G.nbr)));
   G.value = malloc(x * sizeof(*(G.value)));
   G.mark = malloc(x * sizeof(*(G.mark)));
+  memset(G.flag, M_NULL, x * y); // initialise
 
   for (int i = 0; i < x; i++) {
-    G.value[i] = malloc(y * sizeof(*(G.value[i])));
-    G.mark[i] = malloc(y * sizeof(*(G.mark[i])));
-    for (int j = 0; j < y; j++)
-      G.mark[i][j] = M_NULL; // initialise
+    G.value[i] = G.cell + i * y;
+    G.mark[i] = G.flag + i * y;
   }
+  for (int k = 0; k < 8; k++)
+    G.off[k] = around[k].x * y + around[k].y;
 
   gridImage = malloc(3 * x * y * sizeof(GLubyte));
   return G;
@@ -356,44 +360,6 @@ bool   erase   = true;
 double scale   = 1;
 GLfloat sizePt = 5.0f;
 
-bool NextPermutation(int *P, int n) {
-  /*
-    Génère la prochaine permutation P de taille n dans l'ordre
-    lexicographique. On renvoie true si la prochaine permutation a pu
-    être déterminée et false si P était la dernière permutation (et
-    alors P n'est pas modifiée). Il n'est pas nécessaire que les
-    valeurs de P soit dans [0,n[.
-
-    On se base sur l'algorithme classique qui est:
-
-    1. Trouver le plus grand index i tel que P[i] < P[i+1].
-    S'il n'existe pas, la dernière permutation est atteinte.
-    2. Trouver le plus grand indice j tel que P[i] < P[j].
-    3. Echanger P[i] avec P[j].
-    4. Renverser la suite de P[i+1] jusqu'au dernier élément.
-
-  */
-  int i=-1, j, m=n-1, t;
-
-  /* étape 1: cherche i le plus grand tq P[i]<P[i+1] */
-  for (j = 0; j < m; j++)
-    if (P[j] < P[j + 1]) i = j; /* on a trouvé un i tq P[i]<P[i+1] */
-  if (i < 0) return false; /* le plus grand i tq P[i]<[i+1] n'existe pas */
-
-  /* étape 2: cherche j le plus grand tq P[i]<P[j] */
-  for (j = i+1; (j<n) && (P[i]<P[j]) ; j++);
-  j--;
-
-  /* étape 3: échange P[i] et P[j] */
-  SWAP(P[i], P[j], t);
-
-  /* étape 4: renverse P[i+1]...P[n-1] */
-  for (++i; i < m; i++, m--)
-    SWAP(P[i], P[m], t);
-
-  return true;
-}
-
 char *TopChrono(int const i) {
 #define CHRONOMAX 10
   /*
@@ -532,15 +498,34 @@ position randomPosition(grid G, int t) {
 // Libère les pointeurs alloués par allocGrid().
 //
 void freeGrid(grid G) {
-  for (int i = 0; i < G.X; i++) {
-    free(G.value[i]);
-    free(G.mark[i]);
-  }
   free(G.value);
   free(G.mark);
+  free(G.cell);
+  free(G.flag);
+  free(G.nbr);
   free(gridImage);
 }
 
+const position around[8] = {
+  {-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1},
+};
+
+//
+// Les cases du bord n'ont aucun voisin: un chemin ne peut pas sortir
+// de la grille, même si le bord n'est pas un mur.
+//
+void maskGrid(grid G) {
+  memset(G.nbr, 0, G.X * G.Y);
+  for (int i = 1; i < G.X - 1; i++)
+    for (int j = 1; j < G.Y - 1; j++) {
+      int const u = i * G.Y + j;
+      uint8_t m = 0;
+      for (int k = 0; k < 8; k++)
+        m |= (G.cell[u + G.off[k]] != V_WALL) << k;
+      G.nbr[u] = m;
+    }
+}
+
 //
 // Renvoie une grille de dimensions x,y rempli de points aléatoires de
 // type et de densité donnés. Le départ et la destination sont
@@ -1,17 +1,8 @@
 #ifndef __TOOLS_H__
 #define __TOOLS_H__
 
-#include <stdbool.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <unistd.h>
-#include <float.h>
-#include <math.h>
-#include <string.h>
-#include <strings.h>
-#include <time.h>
-#include <sys/time.h>
-#include <limits.h>
+#include "core.h"
+#include <stdint.h>
 
 // alt: -Wno-deprecated-declarations 
 #define GL_SILENCE_DEPRECATION
@@ -26,16 +17,6 @@
 #include <SDL2/SDL_opengl.h>
 
 
-// échange les variables x et y, via z
-#define SWAP(x, y, z)  (z) = (x), (x) = (y), (y) = (z)
-
-// réel aléatoire dans [0,1]
-#define RAND01  ((double)random()/RAND_MAX)
-
-// taille maximum du nom d'un fichier
-#define MAX_FILE_NAME  256
-
-
 ////////////////////////
 //
 // SPÉCIFIQUE POUR TSP
@@ -43,18 +24,6 @@
 ////////////////////////
 
 
-// Un point (x,y).
-typedef struct {
-  double x, y;
-} point;
-
-// Construit la prochaine permutation de P de taille n dans l'ordre
-// lexicographique. Le résultat est écrit dans P. La fonction renvoie
-// true sauf si à l'appel P était la dernière permutation. Dans ce cas
-// false est renvoyé et P n'est pas modifiée. Il n'est pas nécessaire
-// que les valeurs de P soit dans [0,n[.
-bool NextPermutation(int *P, int n);
-
 // Primitives de génération des points.
 point *generatePoints(int n); // n points au hasard dans [0,width] x [0,height]
 point *generateCircles(int n, int k); // n points au hasard sur k cercles concentriques
@@ -74,14 +43,6 @@ point *generateLoad(int *n, char *file); // points lus depuis un fichier
 // Primitives de dessin.
 void drawTour(point *V, int n, int *P); // affichage de la tournée P
 void drawPath(point *V, int n, int *P, int k); // affiche les k premiers points
-
-// Un graphe G (pour MST).
-typedef struct {
-  int n;         // n=nombre de sommets
-  int *deg;      // deg[u]=nombre de voisins du sommet u
-  int **list;    // list[u][i]=i-ème voisin de u, i=0..deg[u]-1
-} graph;
-
 void drawGraph(point *V, int n, int *P, graph G); // affiche graphe, arbre et tournée
 
 
@@ -97,15 +58,25 @@ typedef struct {
   int x, y;
 } position;
 
-// Une grille.
+// Une grille. Les cases sont stockées de manière contiguë, sur un
+// octet: la case (x,y) est la case u = x*Y+y de cell[] et de flag[],
+// et value[x], mark[x] pointent sur la colonne x de ces tableaux.
 typedef struct {
-  int X, Y;       // dimensions: X et Y
-  int **value;    // valuation des cases: value[x][y], 0<=x<X, 0<=y<Y
-  int **mark;     // marquage des cases: mark[x][y], 0<=x<X, 0<=y<Y
-  position start; // position de la source
-  position end;   // position de la destination
+  int X, Y;        // dimensions: X et Y
+  uint8_t **value; // valuation des cases: value[x][y], 0<=x<X, 0<=y<Y
+  uint8_t **mark;  // marquage des cases: mark[x][y], 0<=x<X, 0<=y<Y
+  uint8_t *cell;   // cell[u] = value[x][y]
+  uint8_t *flag;   // flag[u] = mark[x][y]
+  uint8_t *nbr;    // bit k de nbr[u] = 1 ssi u+off[k] n'est pas un mur
+  int off[8];      // off[k] = décalage de u vers son voisin around[k]
+  position start;  // position de la source
+  position end;    // position de la destination
 } grid;
 
+// Les 8 directions vers les voisins d'une case, dans l'ordre des bits
+// de .nbr et des décalages de .off.
+extern const position around[8];
+
 // Valeurs possibles des cases d'une grille pour les champs .value et
 // .mark. L'ordre est important: il doit être cohérent avec les
 // tableaux color[] (de tools.c) et weight[] (de a_star.c).
@@ -150,6 +121,7 @@ void addRandomBlob(grid,int t,int n); // ajoute n blobs de texture t
 void addRandomArc(grid,int t,int n); // ajoute n arcs de texture t
 position randomPosition(grid,int t); // position aléatoire sur texture de type t
 void freeGrid(grid); // libère la mémoire alouée par les fonctions initGridXXX()
+void maskGrid(grid); // calcule .nbr, à refaire si .value a changé
 
 
 ////////////////////////
@@ -0,0 +1,264 @@
+#include "core.h"
+#include "tsp_brute_force.h"
+#include "tsp_heuristic.h"
+#include "tsp_sfc.h"
+#include "tsp_aco.h"
+#include <pthread.h>
+
+//
+//  TSP - COLONIE DE FOURMIS (MAX-MIN ANT SYSTEM)
+//
+//  La phéromone est stockée comme les listes de voisins: tau[u*k+i]
+//  est celle de l'arête u-N[u*k+i], soit n*k valeurs au lieu de n^2.
+//  Une fourmi en u choisit son prochain point parmi les candidats non
+//  visités avec une probabilité proportionnelle à
+//  w[e] = tau[e] * eta[e], où eta[e] = 1/d(e)^beta. Si tous les
+//  candidats sont visités, elle prend le point non visité le plus
+//  proche, trouvé en parcourant la liste des non visités (s'il en
+//  reste peu) ou en largeur le graphe des voisins (s'il en reste
+//  beaucoup).
+//
+//  La mise à jour de la phéromone est faite en une seule passe sur des
+//  tableaux contigus de float, sans dépendance entre cases, que le
+//  compilateur vectorise (-O3): évaporation, dépôt (préparé dans
+//  add[]), bornes [tmin,tmax] de MMAS et recalcul de w[].
+//
+
+#define ACO_K 10        // nombre de voisins candidats
+#define ACO_PBEST 0.05  // pour le calcul de tmin (Stützle & Hoos)
+#define ACO_RESTART 100 // itérations sans amélioration avant réinitialisation
+#define ACO_FLIP 2000   // first_flip() (O(n^2) par flip) jusqu'à cette taille
+
+// Données partagées. Les threads ne font que lire w[].
+typedef struct {
+  point *V;
+  int n, *N;
+  colony opt;
+  float *w;      // w[e] = tau[e]*eta[e]
+  context *ctx;
+} nest;
+
+// Une fourmi par thread à la fois, avec sa zone de travail.
+typedef struct {
+  nest *C;
+  int id;
+  int *T;        // tournée de la fourmi
+  int *best;     // meilleure tournée du thread dans l'itération
+  double wbest;  // sa valeur
+  int *U;        // points non visités
+  int *at;       // at[u] = position de u dans U[], -1 si visité
+  int *Q;        // file du parcours en largeur
+  int *seen;     // seen[u] = dernier parcours ayant vu u
+  int stamp;
+  unsigned seed;
+} ant;
+
+// Retire u des points non visités.
+static inline void visit(ant *A, int *r, int u) {
+  int const i = A->at[u], last = A->U[--(*r)];
+  A->U[i] = last, A->at[last] = i;
+  A->at[u] = -1;
+}
+
+// Le point non visité le plus proche de u, alors que ses candidats
+// sont tous visités. Il en reste r.
+static int nearest(ant *A, int r, int u) {
+  nest *C = A->C;
+  int const k = ACO_K;
+  if((double)r * r < C->n){ // O(r)
+    int b = A->U[0];
+    for(int i=1; i<r; i++)
+      if(dist(C->V[u], C->V[A->U[i]]) < dist(C->V[u], C->V[b])) b = A->U[i];
+    return b;
+  }
+  // O(n/r) en moyenne: le premier non visité trouvé, pas forcément le
+  // plus proche
+  int h = 0, t = 0, s = ++A->stamp;
+  A->Q[t++] = u, A->seen[u] = s;
+  while(h < t){
+    int const x = A->Q[h++];
+    for(int j=0; j<k; j++){
+      int const v = C->N[x*k+j];
+      if(A->seen[v] == s) continue;
+      if(A->at[v] >= 0) return v;
+      A->seen[v] = s, A->Q[t++] = v;
+    }
+  }
+  return A->U[0]; // composante du graphe des voisins épuisée
+}
+
+// Construit la tournée d'une fourmi dans A->T.
+static void walk(ant *A) {
+  nest *C = A->C;
+  int const n = C->n, k = ACO_K;
+  int r = n;
+  for(int i=0; i<n; i++) A->U[i] = i, A->at[i] = i;
+  int u = rand_r(&A->seed) % n;
+  visit(A, &r, u);
+  A->T[0] = u;
+  for(int m=1; m<n; m++){
+    float const *w = C->w + u*k;
+    int const *N = C->N + u*k;
+    float sum = 0;
+    for(int j=0; j<k; j++) if(A->at[N[j]] >= 0) sum += w[j];
+    int v = -1;
+    if(sum > 0){ // roulette
+      float x = sum * (rand_r(&A->seed) / (RAND_MAX + 1.0f));
+      for(int j=0; j<k; j++){
+        if(A->at[N[j]] < 0) continue;
+        v = N[j];
+        if((x -= w[j]) < 0) break;
+      }
+    }else v = nearest(A, r, u);
+    visit(A, &r, v);
+    A->T[m] = u = v;
+  }
+}
+
+static void *run(void *arg) {
+  ant *A = arg;
+  nest *C = A->C;
+  A->wbest = DBL_MAX;
+  for(int a=A->id; a<C->opt.ants && !ctx_step(C->ctx, 4L*C->n); a+=C->opt.threads){
+    walk(A);
+    double const w = two_opt(C->V, C->n, A->T, C->N, ACO_K, NULL, C->ctx);
+    if(w < A->wbest){
+      A->wbest = w;
+      int *t = A->best;
+      A->best = A->T, A->T = t;
+    }
+  }
+  return NULL;
+}
+
+// Prépare dans add[] le dépôt q sur les arêtes de la tournée P, dans
+// les deux sens quand ils sont candidats.
+static void deposit(int n, int *N, int *P, float *add, float q) {
+  int const k = ACO_K;
+  for(int i=0; i<n; i++){
+    int const u = P[i], v = P[(i+1)%n];
+    for(int j=0; j<k; j++) if(N[u*k+j] == v){ add[u*k+j] += q; break; }
+    for(int j=0; j<k; j++) if(N[v*k+j] == u){ add[v*k+j] += q; break; }
+  }
+}
+
+// tau = min(max(tau*(1-rho)+add, tmin), tmax), puis w = tau*eta et
+// add = 0. Boucle sans branchement ni dépendance: vectorisée.
+static void evaporate(float *restrict tau, float *restrict add, float *restrict w,
+                   const float *restrict eta, long m, float rho, float tmin, float tmax) {
+  for(long e=0; e<m; e++){
+    float t = tau[e] * (1 - rho) + add[e];
+    t = (t < tmin)? tmin : t;
+    t = (t > tmax)? tmax : t;
+    tau[e] = t;
+    w[e] = t * eta[e];
+    add[e] = 0;
+  }
+}
+
+double tsp_aco(point *V, int n, int *P, colony opt, context *ctx) {
+  if(n <= ACO_K) return tsp_brute_force_opt(V, n, P, ctx);
+  if(opt.threads < 1) opt.threads = 1;
+  if(opt.ants < 1) opt.ants = 1;
+  if(opt.iterations <= 0 && (ctx == NULL || (ctx->deadline <= 0 && ctx->budget <= 0)))
+    opt.iterations = 100;
+  if(opt.rho <= 0 || opt.rho >= 1) opt.rho = 0.2;
+  int const k = ACO_K, nt = opt.threads;
+  long const m = (long)n*k;
+
+  int *id = renumber(V, n, nt);
+  nest C = { .V = V, .n = n, .opt = opt, .ctx = ctx };
+  C.N = neighbors(V, n, k);
+
+  // tournée de départ
+  greedy_edge(V, n, P, C.N, k, 0, &opt.seed);
+  double best = two_opt(V, n, P, C.N, k, NULL, ctx);
+  if(n <= ACO_FLIP){
+    while(!ctx_step(ctx, (long)n*n) && first_flip(V, n, P) > 0);
+    best = value(V, n, P);
+  }
+
+  float *tau = malloc(m * sizeof(float));
+  float *eta = malloc(m * sizeof(float));
+  float *add = calloc(m, sizeof(float));
+  C.w = malloc(m * sizeof(float));
+  double const p = pow(ACO_PBEST, 1.0/n);
+  double const spread = (1-p) / ((k/2.0 - 1) * p); // tmin/tmax
+  float tmax = 1 / (opt.rho * best), tmin = tmax * spread;
+  for(long e=0; e<m; e++){
+    double const d = dist(V[e/k], V[C.N[e]]);
+    eta[e] = pow(1 / fmax(d, 1E-9), opt.beta);
+    tau[e] = tmax;
+  }
+  evaporate(tau, add, C.w, eta, m, 0, tmin, tmax);
+
+  ant *A = malloc(nt * sizeof(ant));
+  pthread_t *tid = malloc(nt * sizeof(pthread_t));
+  int *zone = malloc((size_t)nt * 6 * n * sizeof(int));
+  for(int t=0; t<nt; t++){
+    int *z = zone + (size_t)t*6*n;
+    A[t] = (ant){ .C = &C, .id = t, .seed = opt.seed + 7919 * (t+1) };
+    A[t].T = z, A[t].best = z + n, A[t].U = z + 2*n, A[t].at = z + 3*n;
+    A[t].Q = z + 4*n, A[t].seen = z + 5*n;
+    for(int u=0; u<n; u++) A[t].seen[u] = 0;
+  }
+
+  for(int it=0, stall=0; ; it++, stall++){
+    if(opt.iterations > 0 && it >= opt.iterations) break;
+    if(ctx_done(ctx)) break;
+    for(int t=1; t<nt; t++) pthread_create(&tid[t], NULL, run, &A[t]);
+    run(&A[0]);
+    for(int t=1; t<nt; t++) pthread_join(tid[t], NULL);
+
+    int b = 0;
+    for(int t=1; t<nt; t++) if(A[t].wbest < A[b].wbest) b = t;
+    // temps écoulé avant qu'une fourmi ait fini: A[b].best n'est pas une
+    // tournée, et il est inutile de mettre à jour les phéromones
+    if(A[b].wbest == DBL_MAX || ctx_done(ctx)){
+      if(A[b].wbest < best - 1E-9) memcpy(P, A[b].best, n * sizeof(int));
+      break;
+    }
+    if(A[b].wbest < best - 1E-9){
+      best = A[b].wbest;
+      memcpy(P, A[b].best, n * sizeof(int));
+      tmax = 1 / (opt.rho * best), tmin = tmax * spread;
+      stall = 0;
+    }
+
+    if(stall >= ACO_RESTART){ // stagnation: réinitialisation
+      for(long e=0; e<m; e++) tau[e] = tmax;
+      evaporate(tau, add, C.w, eta, m, 0, tmin, tmax);
+      stall = 0;
+      continue;
+    }
+    if(it % 5 == 4) deposit(n, C.N, P, add, 1 / best);
+    else deposit(n, C.N, A[b].best, add, 1 / A[b].wbest);
+    evaporate(tau, add, C.w, eta, m, opt.rho, tmin, tmax);
+  }
+
+  if(n <= ACO_FLIP) while(!ctx_step(ctx, (long)n*n) && first_flip(V, n, P) > 0);
+  restore(V, n, P, id);
+
+  free(zone);
+  free(tid);
+  free(A);
+  free(C.w);
+  free(add);
+  free(eta);
+  free(tau);
+  free(C.N);
+  return value(V, n, P);
+}
+
+double tsp_ants(point *V, int n, int *P) {
+  colony const opt = {
+    .threads = sysconf(_SC_NPROCESSORS_ONLN),
+    .ants = 25,
+    .beta = 2,
+    .rho = 0.2,
+    .seed = random(),
+  };
+  context ctx;
+  ctx_init(&ctx, 2, 0);
+  return tsp_aco(V, n, P, opt, &ctx);
+}
@@ -0,0 +1,33 @@
+#ifndef TSP_ACO_H
+#define TSP_ACO_H
+
+#include "core.h"
+#include "tsp_context.h"
+
+// Paramètres de tsp_aco().
+typedef struct {
+  int threads;    // nombre de threads
+  int ants;       // nombre de fourmis par itération
+  int iterations; // nombre maximum d'itérations, 0 = illimité
+  double beta;    // poids de la distance face à la phéromone, par ex. 2
+  double rho;     // taux d'évaporation, par ex. 0.2
+  unsigned seed;  // graine
+} colony;
+
+// Colonie de fourmis MAX-MIN (MMAS). La phéromone n'existe que sur les
+// arêtes u-v où v est l'un des voisins candidats de u. À chaque
+// itération, opt.ants fourmis construisent une tournée en parallèle,
+// améliorée par 2-opt, puis la meilleure de l'itération (ou la
+// meilleure de toutes, une fois sur cinq) dépose sa phéromone. Part de
+// greedy-edge améliorée par 2-opt puis first_flip(), et termine par
+// first_flip() sur la meilleure tournée (first_flip() seulement pour
+// les petites instances, il coûte O(n^2) par flip). S'arrête après
+// opt.iterations itérations ou à l'expiration de ctx (100 itérations si
+// aucun des deux n'est limité). Écrit dans P la meilleure tournée et
+// renvoie sa valeur.
+double tsp_aco(point *V, int n, int *P, colony opt, context *ctx);
+
+// tsp_aco() avec un thread par processeur, 25 fourmis, 2 secondes.
+double tsp_ants(point *V, int n, int *P);
+
+#endif /* TSP_ACO_H */
@@ -0,0 +1,420 @@
+#include "core.h"
+#include "tsp_brute_force.h"
+#include "tsp_mst.h"
+#include "tsp_heuristic.h"
+#include "tsp_bound.h"
+#include <stdint.h>
+
+//
+//  TSP - MINORANT DE HELD-KARP
+//
+//  Pour des potentiels pi[] quelconques, toute tournée a le même poids
+//  pour d et pour d'(u,v) = d(u,v)+pi[u]+pi[v] à 2*somme(pi) près. Une
+//  tournée étant un 1-arbre, le 1-arbre minimum pour d' moins
+//  2*somme(pi) est un minorant. L'ascension de sous-gradient augmente
+//  pi[v] si v a un degré >2 dans le 1-arbre et le diminue s'il est de
+//  degré 1, ce qui pousse le 1-arbre vers une tournée.
+//
+
+#define HK_DENSE 500   // au-delà, ascension sur les arêtes candidates et
+                       // 1-arbre final par boruvka() au lieu de prim()
+#define HK_K 8         // nombre de voisins candidats
+#define HK_PERIOD 20   // pas sans amélioration avant de diviser le pas par 2
+#define HK_STEPS 1000  // nombre maximum de pas de tsp_gap()
+#define HK_LEAF 8      // nombre maximum de points d'une feuille du k-d arbre
+
+static inline double w(point *V, double *pi, int u, int v) {
+  return dist(V[u], V[v]) + pi[u] + pi[v];
+}
+
+// Les deux arêtes les plus légères de 0, en O(n): 0-a et 0-b.
+static double two_edges(point *V, int n, double *pi, int *a, int *b) {
+  double wa = DBL_MAX, wb = DBL_MAX;
+  for(int v=1; v<n; v++){
+    double const x = w(V, pi, 0, v);
+    if(x < wa) wb = wa, *b = *a, wa = x, *a = v;
+    else if(x < wb) wb = x, *b = v;
+  }
+  return wa + wb;
+}
+
+// 1-arbre minimum exact (Prim en O(n^2), sans tas): l'arbre couvrant
+// 1..n-1 est donné par dad[] (dad[1]=-1), order[] est l'ordre d'ajout
+// des points (un ordre topologique depuis 1), et 0 est relié à *a et
+// *b. Calcule deg[] et renvoie le poids moins 2*somme(pi).
+static double prim(point *V, int n, double *pi, int *dad, int *order,
+                   int *deg, int *a, int *b) {
+  double *key = malloc(n * sizeof(double));
+  bool *in = calloc(n, sizeof(bool));
+  for(int v=0; v<n; v++) key[v] = DBL_MAX, dad[v] = -1, deg[v] = 0;
+  double L = 0;
+  int u = 1;
+  key[1] = 0;
+  for(int m=0; m<n-1; m++){
+    in[u] = true, order[m] = u;
+    L += key[u];
+    if(dad[u] >= 0) deg[u]++, deg[dad[u]]++;
+    int next = -1;
+    for(int v=1; v<n; v++){
+      if(in[v]) continue;
+      double const x = w(V, pi, u, v);
+      if(x < key[v]) key[v] = x, dad[v] = u;
+      if(next < 0 || key[v] < key[next]) next = v;
+    }
+    u = next;
+  }
+  L += two_edges(V, n, pi, a, b);
+  deg[0] = 2, deg[*a]++, deg[*b]++;
+  for(int v=0; v<n; v++) L -= 2*pi[v];
+  free(in);
+  free(key);
+  return L;
+}
+
+// Clé entière dans le même ordre que le poids x, arrondi en float.
+static inline uint32_t rkey(double x) {
+  float const f = x;
+  uint32_t k;
+  memcpy(&k, &f, sizeof(k));
+  return (k >> 31)? ~k : k | 0x80000000u;
+}
+
+// Trie les m arêtes E par poids, par un tri radix (4 passes de 8 bits
+// sur rkey()) en O(m), avec le tampon F de m arêtes. qsort() sur les
+// n*HK_K arêtes candidates coûtait l'essentiel de chaque pas.
+static void radix_sort(edge *E, edge *F, int m) {
+  for(int s=0; s<32; s+=8){
+    int c[257] = {0};
+    for(int i=0; i<m; i++) c[(rkey(E[i].weight) >> s & 255) + 1]++;
+    for(int d=0; d<256; d++) c[d+1] += c[d];
+    for(int i=0; i<m; i++) F[c[rkey(E[i].weight) >> s & 255]++] = E[i];
+    edge *t = E; E = F, F = t;
+  }
+}
+
+// 1-arbre minimum restreint aux m arêtes candidates E (qui ne touchent
+// pas 0 et relient 1..n-1), par l'algorithme de Kruskal de tsp_mst().
+// Calcule deg[] et renvoie le poids moins 2*somme(pi), qui n'est pas
+// forcément un minorant. F est un tampon de m arêtes.
+static double kruskal(point *V, int n, double *pi, edge *E, edge *F, int m,
+                      int *parent, int *rank, int *deg) {
+  for(int i=0; i<m; i++) E[i].weight = w(V, pi, E[i].u, E[i].v);
+  radix_sort(E, F, m);
+  for(int v=0; v<n; v++) parent[v] = v, rank[v] = 0, deg[v] = 0;
+  double L = 0;
+  for(int i=0, added=0; i<m && added<n-2; i++){
+    int const x = Find(E[i].u, parent), y = Find(E[i].v, parent);
+    if(x == y) continue;
+    Union(x, y, parent, rank);
+    deg[E[i].u]++, deg[E[i].v]++;
+    L += E[i].weight;
+    added++;
+  }
+  int a = 1, b = 2;
+  L += two_edges(V, n, pi, &a, &b);
+  deg[0] = 2, deg[a]++, deg[b]++;
+  for(int v=0; v<n; v++) L -= 2*pi[v];
+  return L;
+}
+
+// k-d arbre des points 1..n-1 pour boruvka(): le noeud i couvre
+// idx[lo..hi[, de boîte [x0,x1]×[y0,y1], et pmin est le minimum des
+// pi[] de ses points. comp est la composante commune de ses points, ou
+// -1 s'ils ne sont pas tous dans la même.
+typedef struct {
+  double x0, x1, y0, y1, pmin;
+  int lo, hi, left, right, comp;
+} kd_node;
+
+typedef struct {
+  point *V;
+  double *pi;
+  int *idx, *comp;
+  kd_node *T;
+  int nodes;
+} kd_tree;
+
+// Range idx[lo..hi[ de sorte que idx[k] soit à sa place selon la
+// coordonnée x (axis=0) ou y (axis=1), les plus petits avant.
+static inline double kd_coord(point p, int axis) {
+  return axis? p.y : p.x;
+}
+
+static void kd_select(point *V, int *idx, int lo, int hi, int k, int axis) {
+  while(hi - lo > 1){
+    double const p = kd_coord(V[idx[lo + (hi-lo)/2]], axis);
+    int i = lo, j = hi-1;
+    while(i <= j){
+      while(kd_coord(V[idx[i]], axis) < p) i++;
+      while(kd_coord(V[idx[j]], axis) > p) j--;
+      if(i <= j){ int const t = idx[i]; idx[i++] = idx[j], idx[j--] = t; }
+    }
+    if(k <= j) hi = j+1;
+    else if(k >= i) lo = i;
+    else return;
+  }
+}
+
+// Construit le sous-arbre de idx[lo..hi[ et renvoie son numéro. Les
+// fils ont un numéro plus grand que leur père.
+static int kd_build(kd_tree *K, int lo, int hi) {
+  int const i = K->nodes++;
+  kd_node *N = &K->T[i];
+  N->x0 = N->y0 = DBL_MAX, N->x1 = N->y1 = -DBL_MAX;
+  for(int j=lo; j<hi; j++){
+    point const p = K->V[K->idx[j]];
+    N->x0 = fmin(N->x0, p.x), N->x1 = fmax(N->x1, p.x);
+    N->y0 = fmin(N->y0, p.y), N->y1 = fmax(N->y1, p.y);
+  }
+  N->lo = lo, N->hi = hi, N->left = N->right = -1;
+  if(hi - lo > HK_LEAF){
+    int const mid = (lo + hi) / 2;
+    kd_select(K->V, K->idx, lo, hi, mid, (N->y1 - N->y0 > N->x1 - N->x0));
+    int const l = kd_build(K, lo, mid), r = kd_build(K, mid, hi);
+    K->T[i].left = l, K->T[i].right = r; // T[] n'est pas déplacé
+  }
+  return i;
+}
+
+// Distance minimum de p à la boîte du noeud N.
+static inline double kd_box(kd_node *N, point p) {
+  double const dx = fmax(fmax(N->x0 - p.x, p.x - N->x1), 0);
+  double const dy = fmax(fmax(N->y0 - p.y, p.y - N->y1), 0);
+  return sqrt(dx*dx + dy*dy);
+}
+
+// Cherche dans le noeud i le point v hors de la composante c qui
+// minimise d(u,v)+pi[v], s'il est < *best: met alors à jour *best et *v.
+static void kd_search(kd_tree *K, int i, int u, int c, double *best, int *v) {
+  kd_node *N = &K->T[i];
+  if(N->comp == c || kd_box(N, K->V[u]) + N->pmin >= *best) return;
+  if(N->left < 0){
+    for(int j=N->lo; j<N->hi; j++){
+      int const x = K->idx[j];
+      if(K->comp[x] == c) continue;
+      double const d = dist(K->V[u], K->V[x]) + K->pi[x];
+      if(d < *best) *best = d, *v = x;
+    }
+    return;
+  }
+  int l = N->left, r = N->right; // le plus proche d'abord
+  if(kd_box(&K->T[r], K->V[u]) < kd_box(&K->T[l], K->V[u])) l = N->right, r = N->left;
+  kd_search(K, l, u, c, best, v);
+  kd_search(K, r, u, c, best, v);
+}
+
+// 1-arbre minimum exact, comme prim() mais sans dad[] ni deg[], par
+// l'algorithme de Borůvka: à chaque tour, chaque composante est reliée
+// par son arête la plus légère vers une autre, trouvée dans un k-d
+// arbre où l'on élague les noeuds d'une seule composante et ceux dont
+// la borne distance + pmin dépasse la meilleure arête connue. Il y a
+// O(log n) tours, et chaque recherche coûte en pratique O(log n) pour
+// des points répartis dans le plan, au lieu des O(n^2) de prim().
+static double boruvka(point *V, int n, double *pi) {
+  int const m = n-1; // points 1..n-1
+  kd_tree K = { .V = V, .pi = pi };
+  K.idx = malloc(m * sizeof(int));
+  K.comp = malloc(n * sizeof(int));
+  K.T = malloc((4*m/HK_LEAF + 2) * sizeof(kd_node));
+  for(int j=0; j<m; j++) K.idx[j] = j+1;
+  kd_build(&K, 0, m);
+  int *parent = malloc(n * sizeof(int)), *rank = malloc(n * sizeof(int));
+  double *cbest = malloc(n * sizeof(double)); // par composante
+  int *cu = malloc(n * sizeof(int)), *cv = malloc(n * sizeof(int));
+  for(int v=0; v<n; v++) parent[v] = v, rank[v] = 0;
+
+  double L = 0;
+  for(int added=0; added < m-1; ){
+    for(int v=1; v<n; v++) K.comp[v] = Find(v, parent), cbest[v] = DBL_MAX;
+    for(int i=K.nodes-1; i>=0; i--){ // fils avant pères
+      kd_node *N = &K.T[i];
+      if(N->left < 0){
+        N->comp = K.comp[K.idx[N->lo]], N->pmin = DBL_MAX;
+        for(int j=N->lo; j<N->hi; j++){
+          int const x = K.idx[j];
+          if(K.comp[x] != N->comp) N->comp = -1;
+          N->pmin = fmin(N->pmin, pi[x]);
+        }
+      }else{
+        kd_node *A = &K.T[N->left], *B = &K.T[N->right];
+        N->comp = (A->comp == B->comp)? A->comp : -1;
+        N->pmin = fmin(A->pmin, B->pmin);
+      }
+    }
+    for(int u=1; u<n; u++){
+      int const c = K.comp[u];
+      double best = cbest[c] - pi[u]; // à battre pour la composante
+      int v = -1;
+      kd_search(&K, 0, u, c, &best, &v);
+      if(v >= 0) cbest[c] = best + pi[u], cu[c] = u, cv[c] = v;
+    }
+    for(int c=1; c<n; c++){
+      if(K.comp[c] != c || cbest[c] == DBL_MAX) continue;
+      int const x = Find(cu[c], parent), y = Find(cv[c], parent);
+      if(x == y) continue; // déjà reliées ce tour-ci
+      Union(x, y, parent, rank);
+      L += w(V, pi, cu[c], cv[c]);
+      added++;
+    }
+  }
+
+  int a = 1, b = 2;
+  L += two_edges(V, n, pi, &a, &b);
+  for(int v=0; v<n; v++) L -= 2*pi[v];
+  free(cv);
+  free(cu);
+  free(cbest);
+  free(rank);
+  free(parent);
+  free(K.T);
+  free(K.comp);
+  free(K.idx);
+  return L;
+}
+
+double one_tree(point *V, int n, double *pi, graph T) {
+  int *dad = malloc(n * sizeof(int));
+  int *order = malloc(n * sizeof(int));
+  int *deg = malloc(n * sizeof(int));
+  int a = 1, b = 2;
+  double const L = prim(V, n, pi, dad, order, deg, &a, &b);
+  for(int v=0; v<n; v++) T.deg[v] = 0;
+  for(int v=2; v<n; v++) addEdge(T, v, dad[v]);
+  addEdge(T, 0, a);
+  addEdge(T, 0, b);
+  free(deg);
+  free(order);
+  free(dad);
+  return L;
+}
+
+double held_karp(point *V, int n, int *P, double *pi, int iterations, context *ctx) {
+  for(int v=0; v<n; v++) pi[v] = 0;
+  if(n < 3) return value(V, n, P);
+  double const ub = value(V, n, P);
+  int *dad = malloc(n * sizeof(int));
+  int *order = malloc(n * sizeof(int));
+  int *deg = malloc(n * sizeof(int));
+  double *pi0 = malloc(n * sizeof(double)); // meilleurs potentiels
+  memcpy(pi0, pi, n * sizeof(double));
+  int a, b;
+
+  // arêtes candidates sans le point 0: voisins (une seule fois par
+  // arête) et arêtes de P, qui garantissent la connexité
+  bool const dense = (n <= HK_DENSE);
+  edge *E = NULL;
+  int *parent = NULL, *rank = NULL, m = 0;
+  if(!dense){
+    int *N = neighbors(V, n, HK_K);
+    E = malloc(2 * (n*HK_K + n) * sizeof(edge)); // arêtes et tampon de tri
+    for(int u=1; u<n; u++)
+      for(int i=0; i<HK_K; i++){
+        int const v = N[u*HK_K+i];
+        bool twice = false; // v-u déjà vue depuis v<u ?
+        for(int j=0; j<HK_K && v<u; j++) twice |= (N[v*HK_K+j] == u);
+        if(v != 0 && !twice) E[m++] = (edge){ .u = u, .v = v };
+      }
+    for(int i=0; i<n; i++){
+      int const u = P[i], v = P[(i+1)%n];
+      if(u != 0 && v != 0) E[m++] = (edge){ .u = u, .v = v };
+    }
+    parent = malloc(n * sizeof(int));
+    rank = malloc(n * sizeof(int));
+    free(N);
+  }
+
+  double best = -DBL_MAX, lambda = 2;
+  for(int it=0, stall=0; it<iterations && lambda>1E-6 && !ctx_step(ctx, (long)n*HK_K); it++){
+    double const L = dense? prim(V, n, pi, dad, order, deg, &a, &b)
+                          : kruskal(V, n, pi, E, E + m, m, parent, rank, deg);
+    if(L > best + 1E-9){
+      best = L, stall = 0;
+      memcpy(pi0, pi, n * sizeof(double));
+    }else if(++stall >= HK_PERIOD) lambda /= 2, stall = 0;
+    double norm = 0;
+    for(int v=0; v<n; v++) norm += (deg[v]-2) * (deg[v]-2);
+    if(norm == 0) break; // le 1-arbre est une tournée (optimale)
+    double const t = lambda * (ub - L) / norm;
+    if(t <= 0) break;
+    for(int v=0; v<n; v++) pi[v] += t * (deg[v]-2);
+  }
+
+  memcpy(pi, pi0, n * sizeof(double));
+  best = dense? prim(V, n, pi, dad, order, deg, &a, &b) : boruvka(V, n, pi); // exact
+  free(rank);
+  free(parent);
+  free(E);
+  free(pi0);
+  free(deg);
+  free(order);
+  free(dad);
+  return best;
+}
+
+// Insère v de valeur x dans la liste triée C[0..k-1] de valeurs A[].
+static void keep(int *C, double *A, int k, int v, double x) {
+  if(x >= A[k-1]) return;
+  int i = k-1;
+  for(; i>0 && A[i-1] > x; i--) C[i] = C[i-1], A[i] = A[i-1];
+  C[i] = v, A[i] = x;
+}
+
+int *alpha_neighbors(point *V, int n, double *pi, int k) {
+  // beta(u,v) = poids maximum d'une arête du chemin u-v de l'arbre, et
+  // alpha(u,v) = w(u,v) - beta(u,v). Pour u fixé, beta[] est calculé en
+  // O(n) (Helsgaun): d'abord sur le chemin de u à la racine, puis pour
+  // les autres points v dans l'ordre topologique, par
+  // beta[v] = max(beta[dad[v]], w(v,dad[v])). Pour le point 0,
+  // alpha(0,v) = w(0,v) - w(0,b) où 0-b est la plus lourde de ses deux
+  // arêtes.
+  int *N = malloc(n * k * sizeof(int));
+  int *dad = malloc(n * sizeof(int));
+  int *order = malloc(n * sizeof(int));
+  int *deg = malloc(n * sizeof(int));
+  int *mark = malloc(n * sizeof(int));
+  double *beta = malloc(n * sizeof(double));
+  double *A = malloc(k * sizeof(double));
+  int a, b;
+  prim(V, n, pi, dad, order, deg, &a, &b);
+  double const w0 = w(V, pi, 0, b); // w(0,a) <= w(0,b)
+
+  for(int v=0; v<n; v++) mark[v] = -1;
+  for(int u=0; u<n; u++){
+    int *C = N + u*k;
+    for(int i=0; i<k; i++) A[i] = DBL_MAX, C[i] = -1;
+    if(u == 0){
+      for(int v=1; v<n; v++) keep(C, A, k, v, w(V, pi, 0, v) - w0);
+      continue;
+    }
+    keep(C, A, k, 0, (u == a || u == b)? 0 : w(V, pi, 0, u) - w0);
+    beta[u] = -DBL_MAX, mark[u] = u;
+    for(int x=u; dad[x]>=0; x=dad[x]){
+      beta[dad[x]] = fmax(beta[x], w(V, pi, x, dad[x]));
+      mark[dad[x]] = u;
+    }
+    for(int i=0; i<n-1; i++){
+      int const v = order[i];
+      if(mark[v] != u) beta[v] = fmax(beta[dad[v]], w(V, pi, v, dad[v]));
+      if(v != u) keep(C, A, k, v, w(V, pi, u, v) - beta[v]);
+    }
+  }
+
+  free(A);
+  free(beta);
+  free(mark);
+  free(deg);
+  free(order);
+  free(dad);
+  return N;
+}
+
+double tsp_gap(point *V, int n, int *P) {
+  double *pi = malloc(n * sizeof(double));
+  int const steps = (100 + n/10 < HK_STEPS)? 100 + n/10 : HK_STEPS;
+  double const lb = held_karp(V, n, P, pi, steps, NULL);
+  double const ub = value(V, n, P);
+  double const gap = (lb > 0)? ub/lb - 1 : 0;
+  printf("lower bound: %g, tour: %g, gap: %.3f%%\n", lb, ub, 100*gap);
+  free(pi);
+  return gap;
+}
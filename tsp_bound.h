@@ -0,0 +1,39 @@
+#ifndef TSP_BOUND_H
+#define TSP_BOUND_H
+
+#include "core.h"
+#include "tsp_context.h"
+
+// 1-arbre minimum pour les poids d(u,v)+pi[u]+pi[v]: arbre couvrant
+// minimum des points 1..n-1 plus les deux arêtes les plus légères du
+// point 0. Le 1-arbre est écrit dans le graphe T (créé par
+// createGraph()), dont les degrés sont remis à zéro. Renvoie son poids
+// moins 2*somme(pi), qui est un minorant de la tournée optimale
+// quels que soient les potentiels pi[]. En O(n^2) (Prim).
+double one_tree(point *V, int n, double *pi, graph T);
+
+// Minorant de Held-Karp: optimise les potentiels pi[] (de taille n) par
+// au plus "iterations" pas de sous-gradient, en utilisant la tournée P
+// comme majorant, et écrit les meilleurs potentiels dans pi. Au-delà de
+// 500 points, les 1-arbres de l'ascension sont calculés par Kruskal sur
+// les arêtes candidates (voisins et arêtes de P), triées par un tri
+// radix: O(n) par pas. L'ascension s'arrête aussi à l'expiration de
+// ctx, mais pas le calcul final du 1-arbre exact pour les meilleurs
+// potentiels, sans lequel le minorant renvoyé ne serait pas garanti:
+// Prim en O(n^2) jusqu'à 500 points, et au-delà Borůvka sur un k-d
+// arbre, en O(n log^2 n) en pratique (0.6s pour n=50000, contre 17s).
+double held_karp(point *V, int n, int *P, double *pi, int iterations, context *ctx);
+
+// Listes des k candidats de chaque point par alpha-proximité pour les
+// potentiels pi: alpha(u,v) est l'augmentation du poids du 1-arbre
+// minimum si on lui impose l'arête u-v. Même format que neighbors():
+// N[u*k+i] = i-ème candidat de u, à libérer par l'appelant. Il faut
+// k<n. En O(n^2).
+int *alpha_neighbors(point *V, int n, double *pi, int k);
+
+// Calcule le minorant de Held-Karp, affiche le minorant, la valeur de
+// la tournée P et l'écart entre les deux, et renvoie cet écart
+// relatif (tournée/minorant - 1). L'ascension est limitée à 1000 pas.
+double tsp_gap(point *V, int n, int *P);
+
+#endif /* TSP_BOUND_H */
@@ -1,4 +1,5 @@
-#include "tools.h"
+#include "core.h"
+#include "tsp_context.h"
 #include <math.h>
 
 //
@@ -6,6 +7,7 @@
 //
 // -> la structure "point" est définie dans "tools.h"
 // -> tsp_main peut être testé dès les 3 premières fonctions codées
+// -> une itération du contexte ctx est une permutation examinée
 //
 
 double dist(point A, point B) {
@@ -24,7 +26,7 @@ double value(point *V, int n, int *P) {
   return val;
 }
 
-double tsp_brute_force(point *V, int n, int *Q) {
+double tsp_brute_force(point *V, int n, int *Q, context *ctx) {
   double longueur = DBL_MAX;
   int perm [n];
   for(int i=0; i<n ; i++){
@@ -39,7 +41,7 @@ double tsp_brute_force(point *V, int n, int *Q) {
         Q[i] = perm[i];
       }
     }
-  }while(NextPermutation(perm,n));
+  }while(NextPermutation(perm,n) && !ctx_step(ctx, n));
   return longueur;
 }
 
@@ -66,7 +68,7 @@ double value_opt(point *V, int n, int *P, double w) {
   return val;
 }
 
-double tsp_brute_force_opt(point *V, int n, int *Q) {
+double tsp_brute_force_opt(point *V, int n, int *Q, context *ctx) {
   double longueur = DBL_MAX;
   int perm [n];
   for(int i=0; i<n ; i++){
@@ -83,6 +85,6 @@ double tsp_brute_force_opt(point *V, int n, int *Q) {
           Q[i] = perm[i];
       }
     }
-  }while(NextPermutation(perm,n));
+  }while(NextPermutation(perm,n) && !ctx_step(ctx, n));
   return longueur;
 }
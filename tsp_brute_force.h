@@ -1,13 +1,14 @@
 #ifndef TSP_BRUTE_FORCE_H
 #define TSP_BRUTE_FORCE_H
 
-#include "tools.h"
+#include "core.h"
+#include "tsp_context.h"
 
 double dist(point A, point B);
 double value(point *V, int n, int *P);
-double tsp_brute_force(point *V, int n, int *Q);
+double tsp_brute_force(point *V, int n, int *Q, context *ctx);
 double value_opt(point *V, int n, int *P, double wmin);
 void MaxPermutation(int *P, int n, int k);
-double tsp_brute_force_opt(point *V, int n, int *Q);
+double tsp_brute_force_opt(point *V, int n, int *Q, context *ctx);
 
 #endif /* TSP_BRUTE_FORCE_H */
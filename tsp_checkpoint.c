@@ -0,0 +1,107 @@
+#include "core.h"
+#include "tsp_checkpoint.h"
+
+//
+//  TSP - POINTS DE REPRISE
+//
+
+static void *writer(void *arg) {
+  checkpoint *K = arg;
+  size_t const len = strlen(K->path);
+  char *tmp = malloc(len + 5);
+  sprintf(tmp, "%s.tmp", K->path);
+  pthread_mutex_lock(&K->lock);
+  for(;;){
+    while(!K->pending && !K->quit) pthread_cond_wait(&K->cond, &K->lock);
+    if(!K->pending) break; // quit sans écriture en attente
+    pthread_mutex_unlock(&K->lock);
+
+    FILE *f = fopen(tmp, "wb");
+    bool ok = (f != NULL);
+    if(ok){
+      K->save(f, K->arg);
+      ok = (fflush(f) == 0) && !ferror(f);
+      ok &= (fclose(f) == 0);
+    }
+    if(ok) ok = (rename(tmp, K->path) == 0);
+    if(!ok) fprintf(stderr, "checkpoint: cannot write %s\n", K->path);
+
+    pthread_mutex_lock(&K->lock);
+    K->written += ok;
+    K->pending = false;
+    pthread_cond_broadcast(&K->cond);
+  }
+  pthread_mutex_unlock(&K->lock);
+  free(tmp);
+  return NULL;
+}
+
+void ckpt_start(checkpoint *K, const char *path) {
+  K->path = strdup(path);
+  K->pending = K->quit = false;
+  K->written = 0;
+  pthread_mutex_init(&K->lock, NULL);
+  pthread_cond_init(&K->cond, NULL);
+  pthread_create(&K->thread, NULL, writer, K);
+}
+
+bool ckpt_post(checkpoint *K, void (*save)(FILE *f, void *arg), void *arg) {
+  if(pthread_mutex_trylock(&K->lock) != 0) return false;
+  bool const ok = !K->pending;
+  if(ok){
+    K->save = save, K->arg = arg;
+    K->pending = true;
+    pthread_cond_broadcast(&K->cond);
+  }
+  pthread_mutex_unlock(&K->lock);
+  return ok;
+}
+
+bool ckpt_busy(checkpoint *K) {
+  pthread_mutex_lock(&K->lock);
+  bool const b = K->pending;
+  pthread_mutex_unlock(&K->lock);
+  return b;
+}
+
+void ckpt_wait(checkpoint *K) {
+  pthread_mutex_lock(&K->lock);
+  while(K->pending) pthread_cond_wait(&K->cond, &K->lock);
+  pthread_mutex_unlock(&K->lock);
+}
+
+void ckpt_stop(checkpoint *K) {
+  pthread_mutex_lock(&K->lock);
+  K->quit = true;
+  pthread_cond_broadcast(&K->cond);
+  pthread_mutex_unlock(&K->lock);
+  pthread_join(K->thread, NULL);
+  pthread_cond_destroy(&K->cond);
+  pthread_mutex_destroy(&K->lock);
+  free(K->path);
+}
+
+// Empreinte FNV-1a des coordonnées des points.
+static uint64_t fingerprint(point *V, int n) {
+  uint64_t h = 14695981039346656037ULL;
+  unsigned char const *b = (unsigned char const *)V;
+  for(size_t i=0; i<(size_t)n*sizeof(point); i++) h = (h ^ b[i]) * 1099511628211ULL;
+  return h;
+}
+
+void ckpt_header(FILE *f, const char *magic, point *V, int n) {
+  uint64_t const h = fingerprint(V, n);
+  fwrite(magic, 1, 4, f);
+  fwrite(&n, sizeof(n), 1, f);
+  fwrite(&h, sizeof(h), 1, f);
+}
+
+bool ckpt_check(FILE *f, const char *magic, point *V, int n) {
+  char m[4];
+  int k;
+  uint64_t h;
+  if(fread(m, 1, 4, f) != 4 || memcmp(m, magic, 4)) return false;
+  if(fread(&k, sizeof(k), 1, f) != 1 || k != n) return false;
+  if(fread(&h, sizeof(h), 1, f) != 1) return false;
+  return h == fingerprint(V, n);
+}
@@ -0,0 +1,56 @@
+#ifndef TSP_CHECKPOINT_H
+#define TSP_CHECKPOINT_H
+
+#include "core.h"
+#include <pthread.h>
+#include <stdint.h>
+
+// Écriture de points de reprise par un thread en arrière-plan. Le
+// solveur demande une écriture avec ckpt_post(), qui ne bloque jamais:
+// si l'écriture précédente n'est pas terminée, la demande est ignorée
+// et le solveur réessaiera plus tard. Le thread appelle save(f,arg) sur
+// un fichier temporaire qui remplace ensuite atomiquement le fichier
+// "path" (rename), si bien qu'une interruption pendant l'écriture
+// laisse intact le point de reprise précédent.
+//
+// Pendant l'écriture, les données lues par save() ne doivent pas être
+// modifiées: l'appelant en fait une copie avant ckpt_post(), ou bien
+// n'écrit que des données qu'il ne modifie plus (cf. dp_save()).
+typedef struct {
+  char *path;
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  void (*save)(FILE *f, void *arg); // écriture demandée
+  void *arg;
+  bool pending; // une écriture demandée et pas encore terminée
+  bool quit;    // le thread doit s'arrêter
+  int written;  // nombre de points de reprise écrits
+} checkpoint;
+
+// Démarre le thread d'écriture dans le fichier path.
+void ckpt_start(checkpoint *K, const char *path);
+
+// Demande l'écriture de save(f,arg). Renvoie faux, sans attendre, si
+// une écriture est déjà en cours.
+bool ckpt_post(checkpoint *K, void (*save)(FILE *f, void *arg), void *arg);
+
+// Vrai si une écriture est en cours.
+bool ckpt_busy(checkpoint *K);
+
+// Attend la fin de l'écriture en cours.
+void ckpt_wait(checkpoint *K);
+
+// Termine l'écriture en cours puis arrête le thread.
+void ckpt_stop(checkpoint *K);
+
+// En-tête d'un point de reprise: le type de solveur (magic, 4
+// caractères), n et une empreinte des points, pour ne pas reprendre un
+// calcul sur une autre instance.
+void ckpt_header(FILE *f, const char *magic, point *V, int n);
+
+// Lit l'en-tête de f et renvoie vrai s'il correspond à magic et aux
+// points V[0..n-1].
+bool ckpt_check(FILE *f, const char *magic, point *V, int n);
+
+#endif /* TSP_CHECKPOINT_H */
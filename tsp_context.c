@@ -0,0 +1,91 @@
+#include "core.h"
+#include "tsp_context.h"
+
+//
+//  TSP - CONTEXTE D'EXÉCUTION
+//
+//  L'expiration est collante: dès qu'elle est constatée (annulation,
+//  budget ou date limite), cancel passe à vrai et les appels suivants
+//  ne font plus que lire ce booléen.
+//
+
+double ctx_now(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + 1E-9 * t.tv_nsec;
+}
+
+void ctx_init(context *C, double seconds, long budget) {
+  C->deadline = (seconds > 0)? ctx_now() + seconds : 0;
+  C->budget = budget;
+  atomic_init(&C->iters, 0);
+  atomic_init(&C->work, 0);
+  atomic_init(&C->cancel, false);
+  C->show = NULL;
+  C->arg = NULL;
+  C->period = 0;
+  atomic_init(&C->last, 0);
+  atomic_init(&C->due, false);
+}
+
+void ctx_progress(context *C, progress show, void *arg, double fps) {
+  C->show = show;
+  C->arg = arg;
+  C->period = (fps > 0)? 1/fps : 0;
+  atomic_store_explicit(&C->last, ctx_now(), memory_order_relaxed);
+}
+
+void ctx_cancel(context *C) {
+  atomic_store(&C->cancel, true);
+}
+
+bool ctx_due(context *C) {
+  return C && atomic_load_explicit(&C->due, memory_order_relaxed);
+}
+
+void ctx_report(context *C, point *V, int n, int *P, int k) {
+  if(C == NULL || C->show == NULL) return;
+  if(!atomic_exchange(&C->due, false)) return;
+  if(!C->show(V, n, P, k, C->arg)) ctx_cancel(C);
+  atomic_store_explicit(&C->last, ctx_now(), memory_order_relaxed);
+}
+
+bool ctx_done(context *C) {
+  if(C == NULL) return false;
+  if(atomic_load_explicit(&C->cancel, memory_order_relaxed)) return true;
+  if((C->budget > 0 && atomic_load(&C->iters) >= C->budget)
+     || (C->deadline > 0 && ctx_now() >= C->deadline)){
+    ctx_cancel(C);
+    return true;
+  }
+  return false;
+}
+
+bool ctx_step(context *C, long work) {
+  if(C == NULL) return false;
+  long const i = atomic_fetch_add_explicit(&C->iters, 1, memory_order_relaxed) + 1;
+  if(C->budget > 0 && i > C->budget) ctx_cancel(C); // B itérations permises
+  if(atomic_load_explicit(&C->cancel, memory_order_relaxed)) return true;
+  if(C->deadline > 0 || C->show){
+    long const w = atomic_fetch_add_explicit(&C->work, work, memory_order_relaxed) + work;
+    if(w >= CTX_STRIDE){
+      atomic_store_explicit(&C->work, 0, memory_order_relaxed);
+      double const t = ctx_now();
+      double const last = atomic_load_explicit(&C->last, memory_order_relaxed);
+      if(C->show && t - last >= C->period){
+        if(!atomic_load(&C->due)) atomic_store(&C->due, true);
+        else if(t - last >= 2*C->period && atomic_exchange(&C->due, false)){
+          // due est resté vrai toute une période: le solveur ne montre
+          // rien, la fonction de progression est appelée sans solution
+          atomic_store_explicit(&C->last, t, memory_order_relaxed);
+          if(!C->show(NULL, 0, NULL, 0, C->arg)) ctx_cancel(C);
+        }
+      }
+      if(C->deadline > 0 && t >= C->deadline){
+        ctx_cancel(C);
+        return true;
+      }
+    }
+  }
+  return false;
+}
@@ -0,0 +1,79 @@
+#ifndef TSP_CONTEXT_H
+#define TSP_CONTEXT_H
+
+#include "core.h"
+#include <stdatomic.h>
+
+// Contexte d'exécution d'un solveur: date limite, budget d'itérations
+// et jeton d'annulation. Les solveurs le consultent régulièrement et,
+// lorsqu'il expire, s'arrêtent en renvoyant la meilleure tournée
+// trouvée jusque-là (toujours une tournée valide) et sa valeur. Un
+// même contexte peut être partagé par plusieurs threads. Partout, un
+// contexte NULL signifie "sans limite".
+//
+// Un contexte peut aussi recevoir une fonction de progression, à qui
+// les solveurs montrent régulièrement leur solution courante (pour
+// l'afficher par exemple), pas plus de "fps" fois par seconde. Pour les
+// solveurs qui ne montrent rien, ctx_step() l'appelle quand même de
+// temps en temps avec P=NULL, ce qui permet de les annuler.
+
+// Fonction de progression: reçoit le chemin P[0..k-1], ou la tournée P
+// si k=n, ou P=NULL (rien à montrer). Renvoie faux pour annuler le
+// calcul. Elle peut être appelée par n'importe quel thread du solveur,
+// mais par un seul à la fois.
+typedef bool (*progress)(point *V, int n, int *P, int k, void *arg);
+
+typedef struct {
+  double deadline;     // date limite (horloge de ctx_now()), 0 = aucune
+  long budget;         // nombre maximum d'itérations, 0 = illimité
+  atomic_long iters;   // itérations comptées par ctx_step()
+  atomic_long work;    // travail compté depuis la dernière lecture d'horloge
+  atomic_bool cancel;  // jeton d'annulation, devient vrai à l'expiration
+  progress show;       // fonction de progression, NULL = aucune
+  void *arg;           // argument de show()
+  double period;       // durée minimum entre deux appels à show()
+  _Atomic double last; // date du dernier appel à show(), écrite par
+                       // le seul thread qui a obtenu due et lue par tous
+  atomic_bool due;     // vrai si show() peut être appelée
+} context;
+
+// Initialise C avec une durée maximum (en secondes, 0 = illimitée) à
+// partir de maintenant et un budget d'itérations (0 = illimité), sans
+// fonction de progression. Avec un budget B, les B premiers appels à
+// ctx_step() renvoient faux (sauf autre expiration), le suivant vrai,
+// et ctx_done() est vrai dès que les B itérations ont été comptées.
+void ctx_init(context *C, double seconds, long budget);
+
+// Installe dans C la fonction de progression show(...,arg), appelée au
+// plus fps fois par seconde.
+void ctx_progress(context *C, progress show, void *arg, double fps);
+
+// Vrai s'il est temps de montrer la solution courante avec
+// ctx_report(). Ne lit pas l'horloge (cf. ctx_step()): le solveur peut
+// s'en servir pour ne construire cette solution qu'à ce moment-là.
+bool ctx_due(context *C);
+
+// Montre à la fonction de progression la solution P (k points, cf.
+// progress). Si elle renvoie faux, C est annulé.
+void ctx_report(context *C, point *V, int n, int *P, int k);
+
+// Annule C: les solveurs qui l'utilisent s'arrêtent au plus vite. Peut
+// être appelée depuis n'importe quel thread.
+void ctx_cancel(context *C);
+
+// Heure courante en secondes (horloge monotone).
+double ctx_now(void);
+
+// Renvoie vrai si C a expiré (annulation, budget ou date limite). Lit
+// l'horloge: à utiliser entre deux étapes coûteuses.
+bool ctx_done(context *C);
+
+// Compte une itération de coût "work" (en opérations élémentaires,
+// environ) et renvoie vrai si C a expiré. L'horloge n'est lue que tous
+// les CTX_STRIDE d'opérations, pour la date limite et pour ctx_due(): à
+// utiliser dans les boucles.
+bool ctx_step(context *C, long work);
+
+#define CTX_STRIDE (1L << 16)
+
+#endif /* TSP_CONTEXT_H */
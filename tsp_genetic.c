@@ -0,0 +1,394 @@
+#include "core.h"
+#include "tsp_brute_force.h"
+#include "tsp_heuristic.h"
+#include "tsp_sfc.h"
+#include "tsp_genetic.h"
+#include <pthread.h>
+
+//
+//  TSP - ALGORITHME GÉNÉTIQUE (EAX)
+//
+//  Croisement EAX de deux parents A et B. Une tournée est vue comme un
+//  graphe où chaque point u a deux voisins adj[2u] et adj[2u+1]. Les
+//  arêtes de A absentes de B et celles de B absentes de A se
+//  décomposent en AB-cycles, qui alternent une arête de A et une arête
+//  de B. Un enfant est obtenu en appliquant un AB-cycle à A: on retire
+//  ses arêtes de A et on ajoute ses arêtes de B. Chaque point garde
+//  deux voisins, mais le résultat est en général un ensemble de
+//  sous-tours. Ils sont fusionnés un à un, le plus petit d'abord, en
+//  remplaçant une arête x-y du sous-tour et une arête v-w d'un autre
+//  (v voisin candidat de x) par x-v et y-w, ou x-w et y-v, au moindre
+//  coût. L'enfant est enfin optimisé par un 2-opt qui ne part que des
+//  points touchés.
+//
+//  Toutes les tournées (population et enfants retenus) sont dans une
+//  seule zone mémoire, et chaque thread a sa zone de travail allouée
+//  une fois pour toutes: aucune allocation par individu ou par enfant,
+//  à part celles de two_opt().
+//
+
+#define GA_K 10     // nombre de voisins candidats
+#define GA_STALL 20 // générations sans amélioration avant l'arrêt
+
+// Zone de travail d'un thread.
+typedef struct {
+  int *a, *b;     // voisins dans A et dans B
+  int *ra, *rb;   // arêtes de A (resp. B) pas encore dans un AB-cycle
+  int *ch;        // voisins dans l'enfant
+  int *path;      // chemin alterné en cours de construction
+  int *last;      // last[2u+p] = position de u dans path de parité p, ou -1
+  int *cyc;       // AB-cycles à la suite, en commençant par une arête de A
+  int *start;     // start[c] = début du cycle c dans cyc[], start[nc] = fin
+  int *pick;      // numéros des cycles, pour les tirer sans remise
+  int *sub;       // sub[u] = numéro du sous-tour de u
+  int *size;      // taille de chaque sous-tour, 0 si fusionné
+  int *head;      // un point de chaque sous-tour
+  int *list;      // points du sous-tour en cours de fusion
+  int *touched;   // points touchés par l'enfant
+  int *T;         // tournée de l'enfant
+  bool *active;   // active[u] = u est dans touched[]
+  unsigned seed;
+} scratch;
+
+// Données partagées.
+typedef struct {
+  point *V;
+  int n, *N;
+  genetic opt;
+  int **pop;      // pop[i] = tournée de l'individu i
+  double *val;    // val[i] = sa valeur
+  int **kid;      // kid[i] = meilleur enfant de i dans la génération
+  double *kval;   // kval[i] = sa valeur, DBL_MAX si aucun
+  int *order;     // order[] = permutation de la population
+  context *ctx;
+  scratch *S;     // S[t] = zone de travail du thread t
+} population;
+
+// Un thread: traite les individus i = id, id+threads, ...
+typedef struct {
+  population *G;
+  int id;
+} worker;
+
+static inline double d(point *V, int u, int v) {
+  return dist(V[u], V[v]);
+}
+
+// Remplace le voisin x de u par y.
+static inline void relink(int *adj, int u, int x, int y) {
+  adj[2*u + (adj[2*u] != x)] = y;
+}
+
+// Calcule adj[] à partir de la tournée P.
+static void adjacency(int n, int *P, int *adj) {
+  for(int i=0; i<n; i++){
+    adj[2*P[i]] = P[(i-1+n)%n];
+    adj[2*P[i]+1] = P[(i+1)%n];
+  }
+}
+
+// Décompose les arêtes de A\B et B\A en AB-cycles et renvoie leur
+// nombre. Le chemin alterné path[0..m] est prolongé par une arête de A
+// (positions paires) ou de B (positions impaires) prise au hasard parmi
+// les arêtes libres. Dès qu'un point revient à une position de même
+// parité j, path[j..m] est un AB-cycle: il est retiré du chemin.
+static int ab_cycles(int n, scratch *S) {
+  for(int u=0; u<n; u++)
+    for(int s=0; s<2; s++){
+      int const x = S->a[2*u+s], y = S->b[2*u+s];
+      S->ra[2*u+s] = (x == S->b[2*u] || x == S->b[2*u+1])? -1 : x;
+      S->rb[2*u+s] = (y == S->a[2*u] || y == S->a[2*u+1])? -1 : y;
+    }
+  int nc = 0, used = 0;
+  S->start[0] = 0;
+  for(int u=0; u<n; u++){
+    int m = 0;
+    S->path[0] = u, S->last[2*u] = 0;
+    while(true){
+      int const x = S->path[m];
+      int *r = (m & 1)? S->rb : S->ra;
+      int s = rand_r(&S->seed) & 1;
+      if(r[2*x+s] < 0) s ^= 1;
+      if(r[2*x+s] < 0) break; // plus d'arête libre (seulement si m=0)
+      int const y = r[2*x+s];
+      r[2*x+s] = -1;
+      r[2*y + (r[2*y] != x)] = -1;
+      S->path[++m] = y;
+      int const j = S->last[2*y + (m & 1)];
+      if(j < 0){
+        S->last[2*y + (m & 1)] = m;
+        continue;
+      }
+      // cycle path[j..m-1], rangé à partir de son arête de A
+      int const L = m - j;
+      for(int i=0; i<L; i++) S->cyc[used+i] = S->path[j + (i + (j & 1)) % L];
+      used += L;
+      S->start[++nc] = used;
+      for(int i=j+1; i<m; i++) S->last[2*S->path[i] + (i & 1)] = -1;
+      m = j;
+    }
+    S->last[2*u] = -1;
+  }
+  return nc;
+}
+
+// Marque u comme touché par l'enfant.
+static inline void touch(scratch *S, int *nt, int u) {
+  if(!S->active[u]) S->active[u] = true, S->touched[(*nt)++] = u;
+}
+
+// Fusionne les sous-tours de S->ch en une tournée écrite dans S->T.
+static void merge(point *V, int n, int *N, scratch *S, int *nt) {
+  int *ch = S->ch, ns = 0, alive = 0;
+  for(int u=0; u<n; u++) S->sub[u] = -1;
+  for(int u=0; u<n; u++){
+    if(S->sub[u] >= 0) continue;
+    int p = ch[2*u+1], x = u, m = 0;
+    do{
+      S->sub[x] = ns, m++;
+      int const y = (ch[2*x] == p)? ch[2*x+1] : ch[2*x];
+      p = x, x = y;
+    }while(x != u);
+    S->size[ns] = m, S->head[ns++] = u;
+  }
+
+  for(alive=ns; alive>1; alive--){
+    int s = -1;
+    for(int i=0; i<ns; i++)
+      if(S->size[i] > 0 && (s < 0 || S->size[i] < S->size[s])) s = i;
+    int m = 0, p = ch[2*S->head[s]+1], x = S->head[s];
+    do{
+      S->list[m++] = x;
+      int const y = (ch[2*x] == p)? ch[2*x+1] : ch[2*x];
+      p = x, x = y;
+    }while(x != S->head[s]);
+
+    // meilleure fusion x-y, v-w -> x-v, y-w (ou x-w, y-v si flip)
+    double best = DBL_MAX;
+    int bx = -1, by = -1, bv = -1, bw = -1;
+    bool flip = false;
+    for(int i=0; i<m; i++){
+      int const x = S->list[i];
+      for(int j=0; j<GA_K; j++){
+        int const v = N[x*GA_K+j];
+        if(S->sub[v] == s) continue;
+        for(int e=0; e<2; e++){
+          int const y = ch[2*x+e];
+          for(int f=0; f<2; f++){
+            int const w = ch[2*v+f];
+            double const c = d(V,x,y) + d(V,v,w);
+            double const c1 = d(V,x,v) + d(V,y,w) - c;
+            double const c2 = d(V,x,w) + d(V,y,v) - c;
+            if(c1 < best) best = c1, bx = x, by = y, bv = v, bw = w, flip = false;
+            if(c2 < best) best = c2, bx = x, by = y, bv = v, bw = w, flip = true;
+          }
+        }
+      }
+    }
+    if(bx < 0){ // aucun voisin candidat hors du sous-tour
+      bx = S->list[0], by = ch[2*bx];
+      for(int v=0; v<n; v++)
+        if(S->sub[v] != s && (bv < 0 || d(V,bx,v) < d(V,bx,bv))) bv = v;
+      bw = ch[2*bv];
+    }
+    if(flip){ int const t = bv; bv = bw, bw = t; }
+    relink(ch, bx, by, bv);
+    relink(ch, by, bx, bw);
+    relink(ch, bv, bw, bx);
+    relink(ch, bw, bv, by);
+    touch(S, nt, bx), touch(S, nt, by), touch(S, nt, bv), touch(S, nt, bw);
+
+    int const t = S->sub[bv];
+    for(int i=0; i<m; i++) S->sub[S->list[i]] = t;
+    S->size[t] += S->size[s], S->size[s] = 0;
+  }
+
+  int p = ch[2*0+1], x = 0;
+  for(int i=0; i<n; i++){
+    S->T[i] = x;
+    int const y = (ch[2*x] == p)? ch[2*x+1] : ch[2*x];
+    p = x, x = y;
+  }
+}
+
+// Croise A=pop[i] et B=pop[suivant de i] et écrit le meilleur enfant
+// dans kid[i] s'il est meilleur que A.
+static void crossover(population *G, scratch *S, int i) {
+  point *V = G->V;
+  int const n = G->n, np = G->opt.population;
+  int const A = G->order[i], B = G->order[(i+1)%np];
+  G->kval[A] = DBL_MAX;
+  adjacency(n, G->pop[A], S->a);
+  adjacency(n, G->pop[B], S->b);
+  int const nc = ab_cycles(n, S);
+
+  for(int c=0; c<nc; c++) S->pick[c] = c;
+  for(int k=0; k<G->opt.kids && k<nc && !ctx_step(G->ctx, 4*n); k++){
+    // cycle tiré au hasard sans remise
+    int const r = k + rand_r(&S->seed) % (nc - k), c = S->pick[r];
+    S->pick[r] = S->pick[k], S->pick[k] = c;
+    int const *C = S->cyc + S->start[c];
+    int const L = S->start[c+1] - S->start[c];
+
+    memcpy(S->ch, S->a, 2*n * sizeof(int));
+    int nt = 0;
+    for(int j=0; j<L; j+=2){ // arêtes de A retirées
+      relink(S->ch, C[j], C[j+1], -1);
+      relink(S->ch, C[j+1], C[j], -1);
+    }
+    for(int j=1; j<L; j+=2){ // arêtes de B ajoutées
+      int const x = C[j], y = C[(j+1)%L];
+      relink(S->ch, x, -1, y);
+      relink(S->ch, y, -1, x);
+    }
+    for(int j=0; j<L; j++) touch(S, &nt, C[j]);
+    merge(V, n, G->N, S, &nt);
+    double const w = two_opt(V, n, S->T, G->N, GA_K, S->active, G->ctx);
+    for(int j=0; j<nt; j++) S->active[S->touched[j]] = false;
+    if(fabs(w - G->val[B]) < 1E-9) continue; // copie de B: perte de diversité
+    if(w < G->val[A] - 1E-9 && w < G->kval[A]){
+      G->kval[A] = w;
+      memcpy(G->kid[A], S->T, n * sizeof(int));
+    }
+  }
+}
+
+// Construit les individus i = id, id+threads, ... de la population
+// initiale. Si le contexte expire, seul le premier est construit et les
+// autres reçoivent la valeur DBL_MAX (il n'y aura pas de génération).
+static void *seed_run(void *arg) {
+  worker *W = arg;
+  population *G = W->G;
+  scratch *S = &G->S[W->id];
+  for(int i=W->id; i<G->opt.population; i+=G->opt.threads){
+    if(i > W->id && ctx_done(G->ctx)){
+      G->val[i] = DBL_MAX;
+      continue;
+    }
+    greedy_edge(G->V, G->n, G->pop[i], G->N, GA_K, 0.1, &S->seed);
+    two_opt(G->V, G->n, G->pop[i], G->N, GA_K, NULL, G->ctx);
+    G->val[i] = or_opt(G->V, G->n, G->pop[i], G->N, GA_K, 3, G->ctx);
+  }
+  return NULL;
+}
+
+// Produit les enfants des individus i = id, id+threads, ... de order[].
+static void *breed_run(void *arg) {
+  worker *W = arg;
+  population *G = W->G;
+  for(int i=W->id; i<G->opt.population; i+=G->opt.threads)
+    crossover(G, &G->S[W->id], i);
+  return NULL;
+}
+
+// Exécute f sur tous les threads.
+static void parallel(population *G, worker *W, void *(*f)(void *)) {
+  pthread_t tid[G->opt.threads];
+  for(int t=1; t<G->opt.threads; t++) pthread_create(&tid[t], NULL, f, &W[t]);
+  f(&W[0]);
+  for(int t=1; t<G->opt.threads; t++) pthread_join(tid[t], NULL);
+}
+
+double tsp_genetic(point *V, int n, int *P, genetic opt, context *ctx) {
+  if(n <= GA_K) return tsp_brute_force_opt(V, n, P, ctx);
+  if(opt.threads < 1) opt.threads = 1;
+  if(opt.population < 2) opt.population = 2;
+  if(opt.kids < 1) opt.kids = 1;
+  int const np = opt.population, nt = opt.threads;
+
+  int *id = renumber(V, n, nt);
+  population G = { .V = V, .n = n, .opt = opt, .ctx = ctx };
+  G.N = neighbors(V, n, GA_K);
+
+  // une zone pour toutes les tournées, une zone de travail par thread
+  int *arena = malloc((size_t)2*np*n * sizeof(int));
+  G.pop = malloc(np * sizeof(int*));
+  G.kid = malloc(np * sizeof(int*));
+  G.val = malloc(np * sizeof(double));
+  G.kval = malloc(np * sizeof(double));
+  G.order = malloc(np * sizeof(int));
+  for(int i=0; i<np; i++){
+    G.pop[i] = arena + (size_t)i*n;
+    G.kid[i] = arena + (size_t)(np+i)*n;
+    G.order[i] = i;
+  }
+  size_t const words = 24*(size_t)n + 2;
+  int *work = malloc(nt * words * sizeof(int));
+  bool *active = calloc((size_t)nt*n, sizeof(bool));
+  G.S = malloc(nt * sizeof(scratch));
+  worker *W = malloc(nt * sizeof(worker));
+  for(int t=0; t<nt; t++){
+    int *z = work + t*words;
+    scratch *S = &G.S[t];
+    S->a = z, z += 2*n;
+    S->b = z, z += 2*n;
+    S->ra = z, z += 2*n;
+    S->rb = z, z += 2*n;
+    S->ch = z, z += 2*n;
+    S->last = z, z += 2*n;
+    S->path = z, z += 2*n+1; // au plus 2n arêtes dans les AB-cycles
+    S->cyc = z, z += 2*n;
+    S->start = z, z += n+1;
+    S->pick = z, z += n;
+    S->sub = z, z += n;
+    S->size = z, z += n;
+    S->head = z, z += n;
+    S->list = z, z += n;
+    S->touched = z, z += n;
+    S->T = z;
+    S->active = active + (size_t)t*n;
+    S->seed = opt.seed + 7919 * t;
+    W[t] = (worker){ .G = &G, .id = t };
+  }
+  for(int t=0; t<nt; t++) for(int u=0; u<2*n; u++) G.S[t].last[u] = -1;
+
+  parallel(&G, W, seed_run);
+
+  unsigned seed = opt.seed;
+  int b = 0;
+  for(int i=1; i<np; i++) if(G.val[i] < G.val[b]) b = i;
+  for(int gen=0, stall=0; stall<GA_STALL; gen++){
+    if(opt.generations > 0 && gen >= opt.generations) break;
+    if(ctx_done(ctx)) break;
+    for(int i=np-1; i>0; i--){ // nouvel ordre des couples
+      int const j = rand_r(&seed) % (i+1), t = G.order[i];
+      G.order[i] = G.order[j], G.order[j] = t;
+    }
+    parallel(&G, W, breed_run);
+    double const old = G.val[b];
+    for(int i=0; i<np; i++){
+      if(G.kval[i] >= G.val[i]) continue;
+      int *t = G.pop[i];
+      G.pop[i] = G.kid[i], G.kid[i] = t;
+      G.val[i] = G.kval[i];
+      if(G.val[i] < G.val[b]) b = i;
+    }
+    stall = (G.val[b] < old - 1E-9)? 0 : stall+1;
+  }
+
+  memcpy(P, G.pop[b], n * sizeof(int));
+  restore(V, n, P, id);
+
+  free(W);
+  free(G.S);
+  free(active);
+  free(work);
+  free(G.order);
+  free(G.kval);
+  free(G.val);
+  free(G.kid);
+  free(G.pop);
+  free(arena);
+  free(G.N);
+  return value(V, n, P);
+}
+
+double tsp_eax(point *V, int n, int *P) {
+  genetic const opt = {
+    .threads = sysconf(_SC_NPROCESSORS_ONLN),
+    .population = 100,
+    .kids = 30,
+    .seed = random(),
+  };
+  return tsp_genetic(V, n, P, opt, NULL);
+}
@@ -0,0 +1,31 @@
+#ifndef TSP_GENETIC_H
+#define TSP_GENETIC_H
+
+#include "core.h"
+#include "tsp_context.h"
+
+// Paramètres de tsp_genetic().
+typedef struct {
+  int threads;     // nombre de threads
+  int population;  // nombre d'individus (>=2)
+  int kids;        // nombre maximum d'enfants par couple de parents
+  int generations; // nombre maximum de générations, 0 = illimité
+  unsigned seed;   // graine
+} genetic;
+
+// Algorithme génétique avec le croisement EAX (edge assembly
+// crossover). La population initiale est faite de tournées greedy-edge
+// bruitées optimisées par 2-opt et Or-opt. À chaque génération, chaque
+// individu A est croisé avec le suivant B dans un ordre aléatoire: les
+// enfants sont produits et optimisés (2-opt local) en parallèle, et le
+// meilleur remplace A s'il est meilleur. S'arrête après
+// opt.generations générations, lorsque la meilleure tournée ne
+// s'améliore plus, ou dès que ctx expire (une itération par enfant).
+// Écrit dans P la meilleure tournée et renvoie sa valeur.
+double tsp_genetic(point *V, int n, int *P, genetic opt, context *ctx);
+
+// tsp_genetic() avec un thread par processeur et des paramètres par
+// défaut (100 individus, 30 enfants par couple).
+double tsp_eax(point *V, int n, int *P);
+
+#endif /* TSP_GENETIC_H */
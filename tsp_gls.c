@@ -0,0 +1,359 @@
+#include "core.h"
+#include "heap.h"
+#include "tsp_brute_force.h"
+#include "tsp_heuristic.h"
+#include "tsp_gls.h"
+#include <stdint.h>
+
+//
+//  TSP - RECHERCHE LOCALE GUIDÉE ET RECHERCHE TABOU
+//
+//  Les deux méthodes travaillent sur la tournée P avec pos[P[i]]=i et
+//  les mouvements 2-opt des listes de voisins, comme two_opt(). Elles
+//  associent à certaines arêtes une valeur entière (pénalité pour GLS,
+//  fin de l'interdiction pour tabou), rangée dans une table de hachage
+//  à adressage ouvert: seules les arêtes qui en ont une y sont.
+//
+
+#define GLS_K 8        // nombre de voisins candidats
+#define GLS_ALPHA 0.3  // lambda = GLS_ALPHA * (longueur du 1er optimum) / n
+#define TABU_SAMPLE 1000 // points examinés par itération de tabou
+#define TABU_TENURE 10 // durée minimum d'interdiction, plus n/10 itérations
+
+// Table de hachage arête -> entier, 0 pour une arête absente.
+typedef struct {
+  uint64_t *key; // clé de l'arête u-v, u<v, ou EMPTY
+  int *val;
+  int mask;      // taille-1, une puissance de 2 moins 1
+  int count;     // nombre d'arêtes présentes
+} edgemap;
+
+#define EMPTY UINT64_MAX
+
+static inline uint64_t edge_key(int u, int v) {
+  return (u < v)? ((uint64_t)u << 32) | v : ((uint64_t)v << 32) | u;
+}
+
+static inline int edge_hash(uint64_t key, int mask) {
+  return (key * 0x9E3779B97F4A7C15ULL) >> 40 & mask;
+}
+
+static void map_init(edgemap *M, int size) {
+  int s = 16;
+  while(s < 2*size) s *= 2;
+  M->key = malloc(s * sizeof(uint64_t));
+  M->val = malloc(s * sizeof(int));
+  for(int i=0; i<s; i++) M->key[i] = EMPTY;
+  M->mask = s-1;
+  M->count = 0;
+}
+
+static void map_free(edgemap *M) {
+  free(M->key);
+  free(M->val);
+}
+
+static inline int map_get(const edgemap *M, int u, int v) {
+  uint64_t const key = edge_key(u, v);
+  for(int i=edge_hash(key, M->mask); ; i=(i+1) & M->mask){
+    if(M->key[i] == key) return M->val[i];
+    if(M->key[i] == EMPTY) return 0;
+  }
+}
+
+// Renvoie l'adresse de la valeur de u-v, créée à 0 si besoin. La table
+// est doublée quand elle est à moitié pleine. Si keep>INT_MIN, seules
+// les valeurs >keep sont conservées lors de ce doublement (ce qui peut
+// donc aussi bien la vider).
+static int *map_put(edgemap *M, int u, int v, int keep) {
+  if(2*(M->count+1) > M->mask+1){
+    edgemap old = *M;
+    int live = 0;
+    for(int i=0; i<=old.mask; i++) if(old.key[i] != EMPTY && old.val[i] > keep) live++;
+    map_init(M, 2*live + 16);
+    for(int i=0; i<=old.mask; i++){
+      if(old.key[i] == EMPTY || old.val[i] <= keep) continue;
+      int j = edge_hash(old.key[i], M->mask);
+      while(M->key[j] != EMPTY) j = (j+1) & M->mask;
+      M->key[j] = old.key[i], M->val[j] = old.val[i];
+      M->count++;
+    }
+    map_free(&old);
+  }
+  uint64_t const key = edge_key(u, v);
+  int i = edge_hash(key, M->mask);
+  while(M->key[i] != key && M->key[i] != EMPTY) i = (i+1) & M->mask;
+  if(M->key[i] == EMPTY) M->key[i] = key, M->val[i] = 0, M->count++;
+  return &M->val[i];
+}
+
+//
+//  GLS
+//
+//  Les utilités des arêtes de la tournée sont dans un tas max Q avec
+//  gestion paresseuse (comme pour les insertions): une entrée est
+//  ajoutée quand une arête entre dans la tournée ou que sa pénalité
+//  augmente, et les entrées d'arêtes sorties de la tournée ou de
+//  pénalité périmée sont ignorées quand elles sortent de Q. Rien n'est
+//  donc recalculé sur toute la tournée à chaque optimum local.
+//
+
+// Une entrée de Q: l'utilité de l'arête u-v au moment de l'ajout.
+typedef struct {
+  double util;
+  int u, v;
+} entry;
+
+typedef struct {
+  point *V;
+  int n, *N;
+  int *P, *pos;
+  edgemap pen;    // pénalités
+  double lambda;
+  double cur;     // vraie longueur de P
+  int *F;         // file des points à examiner, circulaire
+  bool *inF;
+  int head, size;
+  heap Q;         // utilités des arêtes de la tournée
+  entry *pool;    // entrées de Q
+  int used;       // nombre d'entrées de pool[] utilisées
+  context *ctx;
+} guided;
+
+static int fcmp_util(const void *x, const void *y) {
+  double const a = ((entry*)x)->util, b = ((entry*)y)->util;
+  return (a > b)? -1 : (a < b);
+}
+
+// Coût augmenté de l'arête u-v.
+static inline double g(guided *S, int u, int v) {
+  double const d = dist(S->V[u], S->V[v]);
+  return (S->pen.count == 0)? d : d + S->lambda * map_get(&S->pen, u, v);
+}
+
+static inline double utility(guided *S, int u, int v) {
+  return dist(S->V[u], S->V[v]) / (1 + map_get(&S->pen, u, v));
+}
+
+static inline int succ(int *P, int *pos, int n, int u) {
+  int const i = pos[u] + 1;
+  return P[(i == n)? 0 : i];
+}
+
+static inline int pred(int *P, int *pos, int n, int u) {
+  int const i = pos[u];
+  return P[(i == 0)? n-1 : i-1];
+}
+
+// Ajoute à Q l'utilité de u-v. Si la réserve est pleine, Q est
+// reconstruit avec les seules arêtes de la tournée.
+static void push(guided *S, int u, int v) {
+  int const n = S->n;
+  if(S->used == 4*n){
+    heap_destroy(S->Q);
+    S->Q = heap_create(4*n, fcmp_util);
+    S->used = 0;
+    for(int i=0; i<n; i++){
+      int const a = S->P[i], b = S->P[(i+1)%n];
+      S->pool[S->used] = (entry){ .util = utility(S, a, b), .u = a, .v = b };
+      heap_add(S->Q, &S->pool[S->used++]);
+    }
+    return;
+  }
+  S->pool[S->used] = (entry){ .util = utility(S, u, v), .u = u, .v = v };
+  heap_add(S->Q, &S->pool[S->used++]);
+}
+
+static inline void activate(guided *S, int u) {
+  if(!S->inF[u]){
+    S->inF[u] = true;
+    S->F[(S->head + S->size++) % S->n] = u;
+  }
+}
+
+// 2-opt sur le coût augmenté à partir des points de la file, jusqu'à
+// un optimum local ou l'expiration du contexte. Met à jour la vraie longueur S->cur, et écrit P
+// dans best si elle devient meilleure que *wbest.
+static void descent(guided *S, int *best, double *wbest) {
+  int const n = S->n, k = GLS_K;
+  int *P = S->P, *pos = S->pos;
+  point *V = S->V;
+  while(S->size > 0 && !ctx_step(S->ctx, 2*k)){
+    int const a = S->F[S->head];
+    S->head = (S->head + 1) % n, S->size--;
+    S->inF[a] = false;
+
+    bool moved = false;
+    for(int dir=0; dir<2 && !moved; dir++){
+      int const sa = dir? pred(P, pos, n, a) : succ(P, pos, n, a);
+      double const g1 = g(S, a, sa);
+      for(int t=0; t<k; t++){
+        int const c = S->N[a*k+t];
+        if(dist(V[a], V[c]) >= g1) break; // d <= g: gain partiel positif exigé
+        int const sc = dir? pred(P, pos, n, c) : succ(P, pos, n, c);
+        if(sc == a || c == sa) continue;
+        double const gain = g1 + g(S, c, sc) - g(S, a, c) - g(S, sa, sc);
+        if(gain <= 1E-10) continue;
+        S->cur += dist(V[a], V[c]) + dist(V[sa], V[sc]) - dist(V[a], V[sa]) - dist(V[c], V[sc]);
+        int const i = pos[a], j = pos[c];
+        if(dir == 0) reverse_tour(P, pos, n, (i+1)%n, j);
+        else reverse_tour(P, pos, n, i, (j-1+n)%n);
+        push(S, a, c), push(S, sa, sc);
+        activate(S, a), activate(S, sa), activate(S, c), activate(S, sc);
+        moved = true;
+        break;
+      }
+    }
+  }
+  if(S->cur < *wbest - 1E-9){
+    *wbest = S->cur;
+    memcpy(best, P, n * sizeof(int));
+  }
+}
+
+// Pénalise les arêtes de la tournée d'utilité maximum.
+static void penalize(guided *S) {
+  int *P = S->P, *pos = S->pos, n = S->n;
+  double max = -1;
+  entry *e;
+  while((e = heap_top(S->Q))){
+    int const u = e->u, v = e->v;
+    bool const valid = (succ(P, pos, n, u) == v || pred(P, pos, n, u) == v)
+                    && e->util == utility(S, u, v);
+    if(valid && e->util < max - 1E-12) break;
+    heap_pop(S->Q);
+    if(!valid) continue;
+    max = e->util;
+    (*map_put(&S->pen, u, v, INT_MIN))++;
+    push(S, u, v);
+    activate(S, u), activate(S, v);
+  }
+}
+
+double tsp_gls(point *V, int n, int *P, context *ctx) {
+  if(n <= GLS_K) return tsp_brute_force_opt(V, n, P, ctx);
+  guided S = { .V = V, .n = n, .P = P, .ctx = ctx };
+  S.N = neighbors(V, n, GLS_K);
+  S.pos = malloc(n * sizeof(int));
+  S.F = malloc(n * sizeof(int));
+  S.inF = malloc(n * sizeof(bool));
+  S.pool = malloc(4*n * sizeof(entry));
+  S.Q = heap_create(4*n, fcmp_util);
+  map_init(&S.pen, n);
+  int *best = malloc(n * sizeof(int));
+  double wbest = value(V, n, P);
+  memcpy(best, P, n * sizeof(int));
+
+  S.cur = wbest;
+  for(int i=0; i<n; i++){
+    S.pos[P[i]] = i;
+    S.F[i] = P[i], S.inF[i] = true;
+  }
+  S.size = n;
+  descent(&S, best, &wbest);
+  S.lambda = GLS_ALPHA * S.cur / n;
+  for(int i=0; i<n; i++) push(&S, P[i], P[(i+1)%n]);
+
+  while(!ctx_done(ctx)){
+    penalize(&S);
+    descent(&S, best, &wbest);
+  }
+
+  memcpy(P, best, n * sizeof(int));
+  map_free(&S.pen);
+  heap_destroy(S.Q);
+  free(best);
+  free(S.pool);
+  free(S.inF);
+  free(S.F);
+  free(S.pos);
+  free(S.N);
+  return value(V, n, P);
+}
+
+//
+//  TABOU
+//
+//  Une itération examine les mouvements 2-opt de TABOU_SAMPLE points
+//  tirés au hasard (tous si n est petit) au lieu de toute la tournée,
+//  pour garder un coût par itération indépendant de n. La table
+//  associe à une arête retirée l'itération jusqu'à laquelle il est
+//  interdit de la recréer; les arêtes dont l'interdiction a expiré sont
+//  éliminées quand la table grandit.
+//
+
+double tsp_tabu(point *V, int n, int *P, context *ctx) {
+  if(n <= GLS_K) return tsp_brute_force_opt(V, n, P, ctx);
+  int const k = GLS_K;
+  int *N = neighbors(V, n, k);
+  int *pos = malloc(n * sizeof(int));
+  int *best = malloc(n * sizeof(int));
+  edgemap tabu;
+  map_init(&tabu, n);
+  unsigned seed = n;
+
+  double cur = two_opt(V, n, P, N, k, NULL, ctx), wbest = cur;
+  memcpy(best, P, n * sizeof(int));
+  for(int i=0; i<n; i++) pos[P[i]] = i;
+  int const sample = (n < TABU_SAMPLE)? n : TABU_SAMPLE;
+  int const base = TABU_TENURE + n/10;
+
+  for(int it=1; !ctx_step(ctx, 4L*sample*k); it++){
+    double min = DBL_MAX;
+    int ba = -1, bc = -1, bdir = 0;
+    for(int s=0; s<sample; s++){
+      int const a = (sample == n)? s : rand_r(&seed) % n;
+      for(int dir=0; dir<2; dir++){
+        int const sa = dir? pred(P, pos, n, a) : succ(P, pos, n, a);
+        double const d1 = dist(V[a], V[sa]);
+        for(int t=0; t<k; t++){
+          int const c = N[a*k+t];
+          int const sc = dir? pred(P, pos, n, c) : succ(P, pos, n, c);
+          if(sc == a || c == sa) continue;
+          double const delta = dist(V[a], V[c]) + dist(V[sa], V[sc]) - d1 - dist(V[c], V[sc]);
+          if(delta >= min) continue;
+          bool const aspiration = cur + delta < wbest - 1E-9;
+          if(!aspiration && (map_get(&tabu, a, c) > it || map_get(&tabu, sa, sc) > it)) continue;
+          min = delta, ba = a, bc = c, bdir = dir;
+        }
+      }
+    }
+    if(ba < 0) continue; // tout est tabou
+
+    int const a = ba, c = bc;
+    int const sa = bdir? pred(P, pos, n, a) : succ(P, pos, n, a);
+    int const sc = bdir? pred(P, pos, n, c) : succ(P, pos, n, c);
+    int const i = pos[a], j = pos[c];
+    if(bdir == 0) reverse_tour(P, pos, n, (i+1)%n, j);
+    else reverse_tour(P, pos, n, i, (j-1+n)%n);
+    int const tenure = base + rand_r(&seed) % base;
+    *map_put(&tabu, a, sa, it) = it + tenure;
+    *map_put(&tabu, c, sc, it) = it + tenure;
+    cur += min;
+    if(cur < wbest - 1E-9){
+      wbest = cur;
+      memcpy(best, P, n * sizeof(int));
+    }
+  }
+
+  memcpy(P, best, n * sizeof(int));
+  map_free(&tabu);
+  free(best);
+  free(pos);
+  free(N);
+  return value(V, n, P);
+}
+
+double tsp_guided(point *V, int n, int *P) {
+  context ctx;
+  ctx_init(&ctx, 2, 0);
+  tsp_greedy_edge(V, n, P);
+  return tsp_gls(V, n, P, &ctx);
+}
+
+double tsp_tabu_search(point *V, int n, int *P) {
+  context ctx;
+  ctx_init(&ctx, 2, 0);
+  tsp_greedy_edge(V, n, P);
+  return tsp_tabu(V, n, P, &ctx);
+}
@@ -0,0 +1,34 @@
+#ifndef TSP_GLS_H
+#define TSP_GLS_H
+
+#include "core.h"
+#include "tsp_context.h"
+
+// Recherche locale guidée (GLS): améliore la tournée P (qui doit être
+// valide) jusqu'à l'expiration de ctx. Chaque optimum local du 2-opt à
+// listes de voisins est suivi de la pénalisation de ses arêtes de plus
+// grande utilité d(e)/(1+p(e)), puis le 2-opt reprend sur le coût
+// augmenté d(e) + lambda*p(e) depuis les extrémités pénalisées. Écrit
+// dans P la meilleure tournée rencontrée (pour le vrai coût) et
+// renvoie sa valeur.
+double tsp_gls(point *V, int n, int *P, context *ctx);
+
+// Recherche tabou jusqu'à l'expiration de ctx à partir de P (qui doit
+// être valide), sur les mêmes mouvements 2-opt. À chaque itération le
+// meilleur mouvement autorisé est appliqué, même s'il dégrade la
+// tournée. Un mouvement est tabou s'il recrée une arête retirée
+// récemment, sauf s'il donne une tournée meilleure que la meilleure
+// connue (aspiration). Écrit dans P la meilleure tournée rencontrée et
+// renvoie sa valeur. Une itération de ctx est un mouvement appliqué.
+// Ces deux recherches ne s'arrêtent qu'à l'expiration de ctx: il faut
+// une date limite, un budget ou une annulation (ctx_cancel(), fonction
+// de progression).
+double tsp_tabu(point *V, int n, int *P, context *ctx);
+
+// Greedy-edge puis tsp_gls() pendant 2 secondes.
+double tsp_guided(point *V, int n, int *P);
+
+// Greedy-edge puis tsp_tabu() pendant 2 secondes.
+double tsp_tabu_search(point *V, int n, int *P);
+
+#endif /* TSP_GLS_H */
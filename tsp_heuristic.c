@@ -1,5 +1,7 @@
-#include "tools.h"
+#include "core.h"
 #include "tsp_brute_force.h"
+#include "tsp_heuristic.h"
+#include "tsp_mst.h"
 
 //
 //  TSP - HEURISTIQUES
@@ -41,17 +43,99 @@ double first_flip(point *V, int n, int *P) {
   return 0.0;
 }
 
-double tsp_flip(point *V, int n, int *P) {
+double tsp_flip(point *V, int n, int *P, context *ctx) {
   // La fonction doit renvoyer la valeur de la tournée obtenue. Pensez
-  // à initialiser P, par exemple à P[i]=i. Pensez aussi faire
-  // drawTour() pour visualiser chaque flip.
-  for(int i=0; i<n; i++){
-    P[i] = i;
-  }
-  while(first_flip(V,n,P) > 0 && running) drawTour(V,n,P);
+  // à initialiser P, par exemple à P[i]=i. La tournée courante est
+  // montrée à la fonction de progression de ctx. Une itération de ctx
+  // est un flip.
+  return tsp_flip_from(V, n, P, NULL, ctx);
+}
+
+double tsp_flip_from(point *V, int n, int *P, constructor init, context *ctx) {
+  // Comme tsp_flip(), mais la tournée de départ est construite par
+  // init() au lieu d'être l'identité P[i]=i (si init=NULL).
+  flip_state *E = flip_create(V, n, init);
+  while(!ctx_step(ctx, (long)n*n) && !flip_step(E, 1))
+    if(ctx_due(ctx)) ctx_report(ctx, V, n, E->P, n);
+  memcpy(P, E->P, n * sizeof(int));
+  flip_free(E);
   return value(V,n,P);
 }
 
+flip_state *flip_create(point *V, int n, constructor init) {
+  flip_state *E = malloc(sizeof(*E));
+  *E = (flip_state){ .V = V, .n = n };
+  E->P = malloc(n * sizeof(int));
+  E->copy = malloc(n * sizeof(int));
+  if(init){
+    init(V, n, E->P);
+  }else{
+    for(int i=0; i<n; i++){
+      E->P[i] = i;
+    }
+  }
+  return E;
+}
+
+void flip_free(flip_state *E) {
+  free(E->copy);
+  free(E->P);
+  free(E);
+}
+
+bool flip_step(flip_state *E, long iterations) {
+  for(; iterations>0 && !E->done; iterations--){
+    if(first_flip(E->V, E->n, E->P) > 0) E->flips++;
+    else E->done = true;
+  }
+  return E->done;
+}
+
+//
+//  Points de reprise de flip_state: en-tête "TSPF", le nombre de flips
+//  réalisés (long) puis la tournée P. À la reprise, le premier
+//  flip_step() constate si P était déjà localement optimale.
+//
+
+void flip_save(FILE *f, void *arg) {
+  flip_state *E = arg;
+  ckpt_header(f, "TSPF", E->V, E->n);
+  fwrite(&E->saved, sizeof(E->saved), 1, f);
+  fwrite(E->copy, sizeof(int), E->n, f);
+}
+
+bool flip_checkpoint(flip_state *E, checkpoint *K) {
+  // La tournée change à chaque flip: le thread d'écriture en lit une
+  // copie, faite ici en O(n).
+  if(ckpt_busy(K)) return false;
+  memcpy(E->copy, E->P, E->n * sizeof(int));
+  E->saved = E->flips;
+  return ckpt_post(K, flip_save, E);
+}
+
+flip_state *flip_load(point *V, int n, const char *path) {
+  FILE *f = fopen(path, "rb");
+  if(f == NULL) return NULL;
+  flip_state *E = flip_create(V, n, NULL);
+  bool ok = ckpt_check(f, "TSPF", V, n)
+         && fread(&E->flips, sizeof(E->flips), 1, f) == 1
+         && fread(E->P, sizeof(int), n, f) == (size_t)n;
+  fclose(f);
+  // P doit être une permutation
+  bool *seen = calloc(n, sizeof(bool));
+  for(int i=0; i<n && ok; i++){
+    ok = (E->P[i] >= 0 && E->P[i] < n && !seen[E->P[i]]);
+    if(ok) seen[E->P[i]] = true;
+  }
+  free(seen);
+  if(!ok){
+    flip_free(E);
+    return NULL;
+  }
+  E->saved = E->flips;
+  return E;
+}
+
 double tsp_greedy(point *V, int n, int *P) {
   // La fonction doit renvoyer la valeur de la tournée obtenue. Pensez
   // à initialiser P, par exemple à P[i]=i.
@@ -70,8 +154,390 @@ double tsp_greedy(point *V, int n, int *P) {
       }
     }
     reverse(P,i,jMin);
-    drawPath(V,n,P,i);
-    SDL_Delay(50);
   }
   return value(V,n,P);
 }
+
+//
+//  TSP - LISTES DE VOISINS CANDIDATS
+//
+
+int *neighbors(point *V, int n, int k) {
+  // Renvoie le tableau N des k plus proches voisins de chaque point,
+  // triés par distance croissante: N[u*k+i] = i-ème voisin de u. Il
+  // faut k<n. Les points sont répartis dans une grille uniforme
+  // d'environ 2 points par case, puis pour chaque u on parcourt les
+  // anneaux de cases autour de celle de u jusqu'à ce que le k-ième
+  // voisin courant soit plus proche que le bord de la zone explorée.
+  // Pour des points uniformes le coût est O(n*k), au lieu de O(n^2).
+  int *N = malloc(n * k * sizeof(int));
+  if(k <= 0) return N;
+
+  double xmin = V[0].x, xmax = V[0].x, ymin = V[0].y, ymax = V[0].y;
+  for(int u=1; u<n; u++){
+    xmin = fmin(xmin, V[u].x); xmax = fmax(xmax, V[u].x);
+    ymin = fmin(ymin, V[u].y); ymax = fmax(ymax, V[u].y);
+  }
+  int const g = (int)ceil(sqrt(n/2.0)); // grille g x g
+  double const cw = fmax(xmax-xmin, ymax-ymin) / g + 1E-9; // côté d'une case
+
+  // tri par dénombrement des points selon leur case
+  int *cell = malloc(n * sizeof(int));  // cell[u] = case du point u
+  int *start = calloc(g*g+1, sizeof(int)); // points de la case c: pts[start[c]..start[c+1][
+  int *pts = malloc(n * sizeof(int));
+  for(int u=0; u<n; u++){
+    int cx = (int)((V[u].x-xmin)/cw), cy = (int)((V[u].y-ymin)/cw);
+    if(cx >= g) cx = g-1;
+    if(cy >= g) cy = g-1;
+    cell[u] = cy*g + cx;
+    start[cell[u]+1]++;
+  }
+  for(int c=0; c<g*g; c++) start[c+1] += start[c];
+  int *fill = malloc(g*g * sizeof(int));
+  memcpy(fill, start, g*g * sizeof(int));
+  for(int u=0; u<n; u++) pts[fill[cell[u]]++] = u;
+  free(fill);
+
+  double *d = malloc(k * sizeof(double)); // distances des k meilleurs
+  for(int u=0; u<n; u++){
+    int *L = N + u*k; // liste de u, triée par insertion
+    int m = 0;        // nombre de voisins trouvés
+    int const cx = cell[u]%g, cy = cell[u]/g;
+    for(int r=0; r<g; r++){
+      for(int y=cy-r; y<=cy+r; y++){
+        if(y<0 || y>=g) continue;
+        // sur les lignes intérieures, seules les 2 cases du bord de
+        // l'anneau sont nouvelles
+        int const step = (y==cy-r || y==cy+r)? 1 : 2*r;
+        for(int x=cx-r; x<=cx+r; x+=(step? step : 1)){
+          if(x<0 || x>=g) continue;
+          int const c = y*g + x;
+          for(int i=start[c]; i<start[c+1]; i++){
+            int const v = pts[i];
+            if(v == u) continue;
+            double const dv = dist(V[u], V[v]);
+            if(m == k && dv >= d[k-1]) continue;
+            int j = (m < k)? m++ : k-1;
+            while(j>0 && d[j-1] > dv){
+              d[j] = d[j-1]; L[j] = L[j-1];
+              j--;
+            }
+            d[j] = dv; L[j] = v;
+          }
+        }
+      }
+      // distance minimale de u à une case hors de l'anneau r
+      double const border = fmin(fmin(V[u].x-xmin-(cx-r)*cw, xmin+(cx+r+1)*cw-V[u].x),
+                                 fmin(V[u].y-ymin-(cy-r)*cw, ymin+(cy+r+1)*cw-V[u].y));
+      if(m == k && d[k-1] <= border) break;
+    }
+  }
+
+  free(d);
+  free(pts);
+  free(start);
+  free(cell);
+  return N;
+}
+
+//
+//  TSP - GREEDY-EDGE
+//
+
+// nombre de voisins candidats pour tsp_greedy_edge()
+#define GREEDY_EDGE_K 10
+
+// Ajoute à la solution partielle (adj,deg) les arêtes du tableau trié
+// E qui ne créent ni sommet de degré 3 ni cycle. Renvoie le nombre
+// d'arêtes ajoutées.
+static int greedy_match(edge *E, int m, int *deg, int *adj, int *parent, int *rank) {
+  int nbAjout = 0;
+  for(int i=0; i<m; i++){
+    int const u = E[i].u, v = E[i].v;
+    if(deg[u] == 2 || deg[v] == 2) continue;
+    int const ru = Find(u, parent), rv = Find(v, parent);
+    if(ru == rv) continue;
+    Union(ru, rv, parent, rank);
+    adj[2*u + deg[u]++] = v;
+    adj[2*v + deg[v]++] = u;
+    nbAjout++;
+  }
+  return nbAjout;
+}
+
+double tsp_greedy_edge(point *V, int n, int *P) {
+  // Heuristique gloutonne sur les arêtes: on ajoute les arêtes par
+  // ordre de poids croissant tant qu'elles ne créent ni sommet de
+  // degré 3 ni cycle prématuré (testé avec Union-Find comme pour
+  // tsp_mst()). Seules les arêtes vers les GREEDY_EDGE_K plus proches
+  // voisins sont candidates, ce qui donne O(n log n). Les fragments
+  // restants sont ensuite raccordés de la même manière entre leurs
+  // extrémités.
+  if(n < 3){
+    for(int i=0; i<n; i++) P[i] = i;
+    return value(V, n, P);
+  }
+  int const k = (n-1 < GREEDY_EDGE_K)? n-1 : GREEDY_EDGE_K;
+  int *N = neighbors(V, n, k);
+  double const w = greedy_edge(V, n, P, N, k, 0, NULL);
+  free(N);
+  return w;
+}
+
+double greedy_edge(point *V, int n, int *P, int *N, int k, double noise, unsigned *seed) {
+  // Comme tsp_greedy_edge() mais avec des listes de voisins N déjà
+  // calculées. Si noise>0, le poids de chaque arête candidate est
+  // multiplié par 1+noise*r avec r aléatoire dans [0,1[ tiré par
+  // rand_r(seed), ce qui donne une tournée différente à chaque appel.
+  if(n < 3){
+    for(int i=0; i<n; i++) P[i] = i;
+    return value(V, n, P);
+  }
+
+  // arêtes candidates u-v, sans doublon
+  edge *E = malloc(n * k * sizeof(edge));
+  int m = 0;
+  for(int u=0; u<n; u++){
+    for(int i=0; i<k; i++){
+      int const v = N[u*k+i];
+      if(u > v){ // u-v déjà ajoutée si u est dans la liste de v
+        int j = 0;
+        while(j<k && N[v*k+j] != u) j++;
+        if(j < k) continue;
+      }
+      E[m] = (edge){ .u = u, .v = v, .weight = dist(V[u], V[v]) };
+      if(noise > 0) E[m].weight *= 1 + noise * rand_r(seed) / ((double)RAND_MAX + 1);
+      m++;
+    }
+  }
+  qsort(E, m, sizeof(edge), compEdge);
+
+  int *parent = malloc(n * sizeof(int));
+  int *rank = malloc(n * sizeof(int));
+  int *adj = malloc(2 * n * sizeof(int)); // adj[2u], adj[2u+1] = voisins de u, -1 sinon
+  int *deg = malloc(n * sizeof(int));
+  for(int u=0; u<n; u++){
+    parent[u] = u;
+    rank[u] = 0;
+    adj[2*u] = adj[2*u+1] = -1;
+    deg[u] = 0;
+  }
+
+  int nbAjout = greedy_match(E, m, deg, adj, parent, rank);
+
+  // tours suivants: même glouton, mais restreint aux extrémités (deg<2)
+  // des fragments et à leurs propres plus proches voisins, jusqu'à
+  // n'avoir plus qu'un seul fragment. Comme chaque extrémité n'a qu'une
+  // seule autre extrémité dans son fragment, la plus courte arête entre
+  // deux fragments est toujours candidate et chaque tour progresse.
+  int *ends = malloc(n * sizeof(int)); // ends[i] = i-ème extrémité
+  point *W = malloc(n * sizeof(point)); // W[i] = V[ends[i]]
+  while(nbAjout < n-1){
+    int ne = 0;
+    for(int u=0; u<n; u++)
+      if(deg[u] < 2){
+        ends[ne] = u;
+        W[ne++] = V[u];
+      }
+    int const k2 = (ne-1 < k)? ne-1 : k;
+    int *M = neighbors(W, ne, k2);
+    m = 0;
+    for(int i=0; i<ne; i++)
+      for(int j=0; j<k2; j++){
+        int const u = ends[i], v = ends[M[i*k2+j]];
+        if(Find(u, parent) != Find(v, parent))
+          E[m++] = (edge){ .u = u, .v = v, .weight = dist(V[u], V[v]) };
+      }
+    free(M);
+    qsort(E, m, sizeof(edge), compEdge);
+    nbAjout += greedy_match(E, m, deg, adj, parent, rank);
+  }
+
+  // il ne reste qu'un chemin hamiltonien: on le parcourt depuis l'une
+  // de ses extrémités
+  int x = 0;
+  while(deg[x] == 2) x++;
+  for(int t=0, prev=-1; t<n; t++){
+    P[t] = x;
+    int const next = (adj[2*x] != prev)? adj[2*x] : adj[2*x+1];
+    prev = x;
+    x = next;
+  }
+
+  free(W);
+  free(ends);
+  free(deg);
+  free(adj);
+  free(rank);
+  free(parent);
+  free(E);
+  return value(V, n, P);
+}
+
+//
+//  TSP - OR-OPT
+//
+
+double or_opt(point *V, int n, int *P, int *N, int k, int passes, context *ctx) {
+  // Améliore P par déplacements de segments de 1 à 3 points consécutifs
+  // (Or-opt) et renvoie la valeur de la tournée obtenue. Le segment
+  // s1...s2 est retiré d'entre p et q puis réinséré, à l'endroit ou à
+  // l'envers, sur une arête c-d où c est l'un des k voisins candidats
+  // N[] de s1 ou de s2. La tournée est gérée par une liste doublement
+  // chaînée, chaque déplacement coûte donc O(1). On fait au plus
+  // "passes" passes complètes, et on s'arrête dès qu'une passe
+  // n'améliore plus rien ou que ctx expire (une itération par point).
+  if(n < 8) return value(V, n, P);
+  int *next = malloc(n * sizeof(int));
+  int *prev = malloc(n * sizeof(int));
+  for(int i=0; i<n; i++){
+    next[P[i]] = P[(i+1)%n];
+    prev[P[(i+1)%n]] = P[i];
+  }
+
+  bool improved = true;
+  for(int pass=0; pass<passes && improved; pass++){
+    improved = false;
+    for(int s1=0; s1<n; s1++){
+      if(ctx_step(ctx, 6*k)){ pass = passes; break; }
+      int seg[3], s2 = s1;
+      for(int L=1; L<=3; L++){
+        if(L > 1) s2 = next[s2];
+        seg[L-1] = s2;
+        int const p = prev[s1], q = next[s2];
+        double const gain = dist(V[p], V[s1]) + dist(V[s2], V[q]) - dist(V[p], V[q]);
+        // meilleure réinsertion: c-d avec c voisin de e (= s1 ou s2) et
+        // e relié à c, l'autre bout f du segment relié à d
+        double best = 1E-10;
+        int bc = -1, bd = -1, be = -1;
+        for(int side=0; side<2; side++){
+          int const e = side? s2 : s1, f = side? s1 : s2;
+          for(int i=0; i<k; i++){
+            int const c = N[e*k+i];
+            double const dce = dist(V[c], V[e]);
+            if(dce >= gain) break; // voisins triés: gain partiel positif exigé
+            bool inside = false;
+            for(int j=0; j<L; j++) inside |= (seg[j] == c);
+            if(inside) continue;
+            for(int dir=0; dir<2; dir++){
+              int const d = dir? prev[c] : next[c];
+              bool in = false;
+              for(int j=0; j<L; j++) in |= (seg[j] == d);
+              if(in) continue;
+              double const g = gain - dce - dist(V[f], V[d]) + dist(V[c], V[d]);
+              if(g > best){
+                best = g;
+                bc = c, bd = d, be = e;
+              }
+            }
+          }
+        }
+        if(bc < 0) continue;
+
+        // retire le segment, puis l'insère entre x et y=next[x] dans
+        // l'ordre qui relie bc à be
+        next[p] = q, prev[q] = p;
+        int const x = (bd == next[bc])? bc : bd;
+        int const y = next[x];
+        int A[3];
+        bool const forward = ((x == bc) == (be == s1));
+        for(int j=0; j<L; j++) A[j] = forward? seg[j] : seg[L-1-j];
+        next[x] = A[0], prev[A[0]] = x;
+        for(int j=0; j+1<L; j++) next[A[j]] = A[j+1], prev[A[j+1]] = A[j];
+        next[A[L-1]] = y, prev[y] = A[L-1];
+        improved = true;
+        break; // s1 a bougé: on passe au point suivant
+      }
+    }
+  }
+
+  for(int i=0, u=P[0]; i<n; i++, u=next[u]) P[i] = u;
+  free(prev);
+  free(next);
+  return value(V, n, P);
+}
+
+//
+//  TSP - 2-OPT AVEC LISTES DE VOISINS
+//
+
+void reverse_tour(int *P, int *pos, int n, int i, int j) {
+  // Renverse la partie circulaire P[i]...P[j] de la tournée (de i vers
+  // j en avançant, modulo n) en mettant à jour pos[] (pos[P[i]]=i).
+  // Comme renverser une partie ou son complémentaire donne la même
+  // tournée, on renverse la plus courte des deux.
+  int len = (j - i + n) % n + 1;
+  if(2*len > n){ // complémentaire P[j+1]...P[i-1]
+    int const t = i;
+    i = (j + 1) % n;
+    j = (t - 1 + n) % n;
+    len = n - len;
+  }
+  for(int s=0; s<len/2; s++){
+    int const a = P[i], b = P[j];
+    P[i] = b, pos[b] = i;
+    P[j] = a, pos[a] = j;
+    i = (i + 1) % n;
+    j = (j - 1 + n) % n;
+  }
+}
+
+double two_opt(point *V, int n, int *P, int *N, int k, bool *active, context *ctx) {
+  // Applique des flips (2-opt) à P jusqu'à un optimum local, et renvoie
+  // la valeur de la tournée. Contrairement à first_flip(), seules les
+  // arêtes a-c où c est l'un des k voisins candidats N[] de a sont
+  // essayées, et seuls les points d'une file F sont examinés ("don't
+  // look bits"): au départ ceux pour lesquels active[u] est vrai (tous
+  // si active=NULL), puis les extrémités des arêtes modifiées. Une
+  // itération de ctx est un point examiné.
+  if(n < 5) return value(V, n, P);
+  int *pos = malloc(n * sizeof(int));
+  int *F = malloc(n * sizeof(int)); // file circulaire
+  bool *inF = malloc(n * sizeof(bool));
+  int head = 0, size = 0;
+  for(int i=0; i<n; i++) pos[P[i]] = i;
+  for(int u=0; u<n; u++){
+    inF[u] = (active == NULL) || active[u];
+    if(inF[u]) F[size++] = u;
+  }
+
+  while(size > 0 && !ctx_step(ctx, 2*k)){
+    int const a = F[head];
+    head = (head + 1) % n, size--;
+    inF[a] = false;
+
+    bool moved = false;
+    for(int dir=0; dir<2 && !moved; dir++){
+      // dir=0: arêtes a-succ(a) et c-succ(c) remplacées par a-c et
+      // succ(a)-succ(c); dir=1: idem avec les prédécesseurs
+      int const i = pos[a];
+      int const sa = P[dir? (i-1+n)%n : (i+1)%n];
+      double const d1 = dist(V[a], V[sa]);
+      for(int t=0; t<k; t++){
+        int const c = N[a*k+t];
+        double const g1 = d1 - dist(V[a], V[c]);
+        if(g1 <= 0) break; // voisins triés: gain partiel positif exigé
+        int const j = pos[c];
+        int const sc = P[dir? (j-1+n)%n : (j+1)%n];
+        if(sc == a || c == sa) continue;
+        double const gain = g1 + dist(V[c], V[sc]) - dist(V[sa], V[sc]);
+        if(gain <= 1E-10) continue;
+        if(dir == 0) reverse_tour(P, pos, n, (i+1)%n, j);
+        else reverse_tour(P, pos, n, i, (j-1+n)%n);
+        int const ends[4] = { a, sa, c, sc };
+        for(int e=0; e<4; e++)
+          if(!inF[ends[e]]){
+            inF[ends[e]] = true;
+            F[(head + size++) % n] = ends[e];
+          }
+        moved = true;
+        break;
+      }
+    }
+  }
+
+  free(inF);
+  free(F);
+  free(pos);
+  return value(V, n, P);
+}
@@ -1,11 +1,80 @@
 #ifndef TSP_HEURISTIC_H
 #define TSP_HEURISTIC_H
 
-#include "tools.h"
+#include "core.h"
+#include "tsp_context.h"
+#include "tsp_checkpoint.h"
+
+// Un constructeur de tournée: remplit P et renvoie sa valeur.
+typedef double (*constructor)(point *V, int n, int *P);
 
 void reverse(int *T, int p, int q);
 double first_flip(point *V, int n, int *P);
-double tsp_flip(point *V, int n, int *P);
+double tsp_flip(point *V, int n, int *P, context *ctx);
+double tsp_flip_from(point *V, int n, int *P, constructor init, context *ctx);
+
+// État de tsp_flip_from() pour un calcul par étapes: la tournée
+// courante P, le nombre de flips réalisés et si P est localement
+// optimale (plus de flip possible).
+typedef struct {
+  point *V;
+  int n;
+  int *P;
+  long flips;
+  bool done;
+  int *copy;  // copie de P enregistrée par flip_checkpoint()
+  long saved; // nombre de flips de la copie
+} flip_state;
+
+// Crée l'état à partir de la tournée construite par init() (ou de
+// l'identité si init=NULL).
+flip_state *flip_create(point *V, int n, constructor init);
+
+// Réalise au plus "iterations" flips. Renvoie vrai s'il n'y a plus de
+// flip possible.
+bool flip_step(flip_state *E, long iterations);
+
+// Demande au thread de K d'enregistrer une copie de la tournée. Ne
+// bloque pas: renvoie faux si l'écriture précédente n'est pas finie.
+// Il faut attendre la fin de l'écriture (ckpt_wait()) avant
+// flip_free().
+bool flip_checkpoint(flip_state *E, checkpoint *K);
+
+// Écriture d'un point de reprise de E (void*), pour ckpt_post().
+void flip_save(FILE *f, void *E);
+
+// Reprend le calcul enregistré dans le fichier path pour les points V,
+// ou renvoie NULL (fichier absent, illisible, ou autres points).
+flip_state *flip_load(point *V, int n, const char *path);
+
+void flip_free(flip_state *E);
 double tsp_greedy(point *V, int n, int *P);
 
+// Listes des k plus proches voisins: N[u*k+i] = i-ème voisin de u.
+// Le tableau renvoyé doit être libéré par l'appelant.
+int *neighbors(point *V, int n, int k);
+
+// Heuristique gloutonne sur les arêtes des plus proches voisins.
+double tsp_greedy_edge(point *V, int n, int *P);
+
+// Greedy-edge avec des listes de voisins N (taille k) déjà calculées,
+// et un bruit relatif "noise" sur le poids des arêtes (0 = aucun) tiré
+// avec rand_r(seed).
+double greedy_edge(point *V, int n, int *P, int *N, int k, double noise, unsigned *seed);
+
+// Au plus "passes" passes d'Or-opt sur P, avec les listes de voisins N
+// de taille k, tant que ctx n'a pas expiré. Renvoie la valeur de la
+// nouvelle tournée.
+double or_opt(point *V, int n, int *P, int *N, int k, int passes, context *ctx);
+
+// Renverse P[i]...P[j] (circulairement), ou bien son complémentaire
+// s'il est plus court, en maintenant pos[P[i]]=i.
+void reverse_tour(int *P, int *pos, int n, int i, int j);
+
+// 2-opt sur P avec les listes de voisins N de taille k, en partant des
+// points u tels que active[u] (tous si active=NULL), tant que ctx n'a
+// pas expiré. Renvoie la valeur de la tournée obtenue (localement
+// optimale si ctx n'a pas expiré).
+double two_opt(point *V, int n, int *P, int *N, int k, bool *active, context *ctx);
+
 #endif /* TSP_HEURISTIC_H */
@@ -0,0 +1,580 @@
+#include "core.h"
+#include "heap.h"
+#include "tsp_brute_force.h"
+#include "tsp_heuristic.h"
+#include "tsp_insertion.h"
+
+//
+//  TSP - HEURISTIQUES D'INSERTION
+//
+//  La tournée partielle est une liste doublement chaînée: next[u] et
+//  prev[u] = successeur et prédécesseur de u dans la tournée. Pour
+//  chaque point c on garde sa clé courante key[c] et un tas Q
+//  d'entrées (clé,c). Les clés qui changent ne sont pas modifiées dans
+//  Q: on ajoute une nouvelle entrée et l'ancienne, devenue périmée,
+//  est ignorée lorsqu'elle sort du tas (gestion paresseuse, comme pour
+//  A*).
+//
+//  Pour que chaque insertion ne coûte pas O(n), on ne regarde que les
+//  points proches du point inséré: ses voisins candidats (cf.
+//  neighbors()) et, avec une grille de cases, le point le plus proche
+//  d'une position parmi un ensemble de points qui change.
+//
+
+#define INS_K 8     // nombre de voisins candidats
+#define HULL_ALL 64 // taille maximum d'une enveloppe essayée en entier
+
+HEAP_DEFINE(min, double, int, HEAP_MIN)
+HEAP_DEFINE(max, double, int, HEAP_MAX)
+
+// Carré de la distance entre A et B, pour comparer sans sqrt().
+static inline double dist2(point A, point B) {
+  double const dx = A.x - B.x, dy = A.y - B.y;
+  return dx*dx + dy*dy;
+}
+
+//
+//  Grille de cases
+//
+
+// Grille uniforme d'environ 2 points par case, comme dans neighbors(),
+// sur les points V[0..n-1] dont seuls certains sont présents. Les
+// points présents de la case c sont pts[start[c] .. start[c]+cnt[c]-1],
+// et pts[pos[u]] = u si u est présent. Les cases sont groupées en blocs
+// de BLOCK x BLOCK cases, et bcnt[] compte les points présents de
+// chaque bloc: la recherche saute les blocs vides, nombreux lorsque la
+// plupart des points ont été retirés.
+#define BLOCK 4
+
+typedef struct {
+  point *V;
+  int g, gb;              // grille g x g, gb x gb blocs
+  double xmin, ymin, cw;  // origine et côté d'une case
+  int *cell;              // cell[u] = case du point u
+  int *start, *cnt;
+  int *bcnt;              // bcnt[b] = nombre de points présents du bloc b
+  int *pts, *pos;
+  int m;                  // nombre de points présents
+} buckets;
+
+// Bloc de la case c.
+static inline int block(buckets *B, int c) {
+  return (c/B->g/BLOCK)*B->gb + (c%B->g)/BLOCK;
+}
+
+// Crée la grille des points V[0..n-1], tous présents si full=true,
+// aucun sinon.
+static buckets buckets_create(point *V, int n, bool full) {
+  buckets B;
+  B.V = V;
+  double xmax = V[0].x, ymax = V[0].y;
+  B.xmin = V[0].x, B.ymin = V[0].y;
+  for(int u=1; u<n; u++){
+    B.xmin = fmin(B.xmin, V[u].x); xmax = fmax(xmax, V[u].x);
+    B.ymin = fmin(B.ymin, V[u].y); ymax = fmax(ymax, V[u].y);
+  }
+  B.g = (int)ceil(sqrt(n/2.0));
+  B.gb = (B.g+BLOCK-1)/BLOCK;
+  B.cw = fmax(xmax-B.xmin, ymax-B.ymin) / B.g + 1E-9;
+  B.cell = malloc(n * sizeof(int));
+  B.start = calloc(B.g*B.g+1, sizeof(int));
+  B.cnt = calloc(B.g*B.g, sizeof(int));
+  B.bcnt = calloc(B.gb*B.gb, sizeof(int));
+  B.pts = malloc(n * sizeof(int));
+  B.pos = malloc(n * sizeof(int));
+  for(int u=0; u<n; u++){
+    int cx = (int)((V[u].x-B.xmin)/B.cw), cy = (int)((V[u].y-B.ymin)/B.cw);
+    if(cx >= B.g) cx = B.g-1;
+    if(cy >= B.g) cy = B.g-1;
+    B.cell[u] = cy*B.g + cx;
+    B.start[B.cell[u]+1]++;
+  }
+  for(int c=0; c<B.g*B.g; c++) B.start[c+1] += B.start[c];
+  B.m = 0;
+  if(full)
+    for(int u=0; u<n; u++){
+      int const c = B.cell[u];
+      B.pos[u] = B.start[c] + B.cnt[c]++;
+      B.pts[B.pos[u]] = u;
+      B.bcnt[block(&B, c)]++;
+      B.m++;
+    }
+  return B;
+}
+
+static void buckets_free(buckets *B) {
+  free(B->cell);
+  free(B->start);
+  free(B->cnt);
+  free(B->bcnt);
+  free(B->pts);
+  free(B->pos);
+}
+
+// Ajoute u, absent, à la grille.
+static void buckets_add(buckets *B, int u) {
+  int const c = B->cell[u];
+  B->pos[u] = B->start[c] + B->cnt[c]++;
+  B->pts[B->pos[u]] = u;
+  B->bcnt[block(B, c)]++;
+  B->m++;
+}
+
+// Retire u, présent, de la grille: le dernier point de sa case prend
+// sa place.
+static void buckets_remove(buckets *B, int u) {
+  int const c = B->cell[u];
+  int const last = B->pts[B->start[c] + --B->cnt[c]];
+  B->pts[B->pos[u]] = last;
+  B->pos[last] = B->pos[u];
+  B->bcnt[block(B, c)]--;
+  B->m--;
+}
+
+// Écrit dans L les (au plus) k points présents les plus proches de p,
+// point de V, par distance croissante, et renvoie leur nombre. On
+// parcourt les anneaux de blocs autour de celui de p jusqu'à ce que le
+// k-ième point trouvé soit plus proche que le bord de la zone
+// explorée.
+static int buckets_nearest(buckets *B, point p, int k, int *L) {
+  if(k > B->m) k = B->m;
+  if(k <= 0) return 0;
+  int const g = B->g, gb = B->gb;
+  double const bw = BLOCK * B->cw; // côté d'un bloc
+  int bx = (int)((p.x-B->xmin)/bw), by = (int)((p.y-B->ymin)/bw);
+  if(bx >= gb) bx = gb-1;
+  if(by >= gb) by = gb-1;
+  double d[k]; // carrés des distances des points de L
+  int m = 0;   // nombre de points trouvés
+  for(int r=0; r<gb; r++){
+    for(int y=by-r; y<=by+r; y++){
+      if(y<0 || y>=gb) continue;
+      // sur les lignes intérieures, seuls les 2 blocs du bord de
+      // l'anneau sont nouveaux
+      int const step = (y==by-r || y==by+r)? 1 : 2*r;
+      for(int x=bx-r; x<=bx+r; x+=(step? step : 1)){
+        if(x<0 || x>=gb || B->bcnt[y*gb + x] == 0) continue;
+        for(int cy=y*BLOCK; cy<(y+1)*BLOCK && cy<g; cy++)
+          for(int cx=x*BLOCK; cx<(x+1)*BLOCK && cx<g; cx++){
+            int const c = cy*g + cx;
+            for(int i=B->start[c]; i<B->start[c]+B->cnt[c]; i++){
+              int const v = B->pts[i];
+              double const dv = dist2(p, B->V[v]);
+              if(m == k && dv >= d[k-1]) continue;
+              int j = (m < k)? m++ : k-1;
+              while(j>0 && d[j-1] > dv){
+                d[j] = d[j-1]; L[j] = L[j-1];
+                j--;
+              }
+              d[j] = dv; L[j] = v;
+            }
+          }
+      }
+    }
+    // distance minimale de p à un bloc hors de l'anneau r
+    double const border = fmin(fmin(p.x-B->xmin-(bx-r)*bw, B->xmin+(bx+r+1)*bw-p.x),
+                               fmin(p.y-B->ymin-(by-r)*bw, B->ymin+(by+r+1)*bw-p.y));
+    if(m == k && d[k-1] <= border*border) break;
+  }
+  return m;
+}
+
+// Écrit dans *L (agrandi au besoin, de taille *size) les points
+// présents à distance au plus R de p, et renvoie leur nombre.
+static int buckets_range(buckets *B, point p, double R, int **L, int *size) {
+  int const gb = B->gb;
+  double const bw = BLOCK * B->cw;
+  int const x0 = fmax(0, (p.x-R-B->xmin)/bw), x1 = fmin(gb-1, (p.x+R-B->xmin)/bw);
+  int const y0 = fmax(0, (p.y-R-B->ymin)/bw), y1 = fmin(gb-1, (p.y+R-B->ymin)/bw);
+  int m = 0;
+  for(int y=y0; y<=y1; y++)
+    for(int x=x0; x<=x1; x++){
+      if(B->bcnt[y*gb + x] == 0) continue;
+      for(int cy=y*BLOCK; cy<(y+1)*BLOCK && cy<B->g; cy++)
+        for(int cx=x*BLOCK; cx<(x+1)*BLOCK && cx<B->g; cx++){
+          int const c = cy*B->g + cx;
+          for(int i=B->start[c]; i<B->start[c]+B->cnt[c]; i++){
+            int const v = B->pts[i];
+            if(dist2(p, B->V[v]) > R*R) continue;
+            if(m == *size) *L = realloc(*L, (*size = 2*m+16) * sizeof(int));
+            (*L)[m++] = v;
+          }
+        }
+    }
+  return m;
+}
+
+//
+//  Tournée partielle
+//
+
+typedef struct {
+  point *V;
+  int *next, *prev;
+  bool *in;    // in[c] = vrai ssi c est dans la tournée
+  int *first;  // voisins candidats de c: adj[first[c] .. first[c+1]-1]
+  int *adj;
+} tour;
+
+// Calcule dans T les listes de voisins symétriques: v est voisin de u
+// si v est dans les k plus proches voisins de u ou u dans ceux de v.
+static void tour_neighbors(tour *T, int n) {
+  int const k = (n-1 < INS_K)? n-1 : INS_K;
+  int *N = neighbors(T->V, n, k);
+  T->first = calloc(n+1, sizeof(int));
+  for(int u=0; u<n; u++)
+    for(int i=0; i<k; i++){
+      T->first[u+1]++;
+      T->first[N[u*k+i]+1]++;
+    }
+  for(int u=0; u<n; u++) T->first[u+1] += T->first[u];
+  int *fill = malloc(n * sizeof(int));
+  memcpy(fill, T->first, n * sizeof(int));
+  T->adj = malloc(T->first[n] * sizeof(int));
+  for(int u=0; u<n; u++)
+    for(int i=0; i<k; i++){
+      int const v = N[u*k+i];
+      T->adj[fill[u]++] = v;
+      T->adj[fill[v]++] = u;
+    }
+  free(fill);
+  free(N);
+}
+
+static tour tour_create(point *V, int n, bool candidates) {
+  tour T;
+  T.V = V;
+  T.next = malloc(n * sizeof(int));
+  T.prev = malloc(n * sizeof(int));
+  T.in = calloc(n, sizeof(bool));
+  T.first = T.adj = NULL;
+  if(candidates) tour_neighbors(&T, n);
+  return T;
+}
+
+static void tour_free(tour *T) {
+  free(T->next);
+  free(T->prev);
+  free(T->in);
+  free(T->first);
+  free(T->adj);
+}
+
+// Insère c entre a et next[a].
+static void insert(tour *T, int a, int c) {
+  int const b = T->next[a];
+  T->next[c] = b, T->prev[c] = a;
+  T->next[a] = c, T->prev[b] = c;
+  T->in[c] = true;
+}
+
+// Coût d'insertion de c entre a et b.
+static inline double cost(point *V, int a, int c, int b) {
+  return dist(V[a], V[c]) + dist(V[c], V[b]) - dist(V[a], V[b]);
+}
+
+// Essaye d'insérer c sur les arêtes prev[a]-a et a-next[a], a dans la
+// tournée: met à jour *min et le point *best après lequel insérer.
+static void try_edges(tour *T, int c, int a, double *min, int *best) {
+  int const p = T->prev[a], b = T->next[a];
+  double const c1 = cost(T->V, p, c, a), c2 = cost(T->V, a, c, b);
+  if(c1 < *min) *min = c1, *best = p;
+  if(c2 < *min) *min = c2, *best = a;
+}
+
+// Renvoie le coût minimum d'insertion de c sur une arête candidate,
+// c'est-à-dire une arête de la tournée qui touche un voisin de c ou
+// l'un des points L[0..m-1] de la tournée, et écrit dans *best le point
+// après lequel insérer c. Renvoie DBL_MAX s'il n'y a aucune arête
+// candidate.
+static double candidate(tour *T, int c, int *L, int m, int *best) {
+  double min = DBL_MAX;
+  for(int i=T->first[c]; i<T->first[c+1]; i++)
+    if(T->in[T->adj[i]]) try_edges(T, c, T->adj[i], &min, best);
+  for(int i=0; i<m; i++) try_edges(T, c, L[i], &min, best);
+  return min;
+}
+
+// Écrit dans P la tournée next[] depuis s et renvoie sa valeur.
+static double extract(point *V, int n, int *next, int s, int *P) {
+  for(int i=0, u=s; i<n; i++, u=next[u]) P[i] = u;
+  return value(V, n, P);
+}
+
+// Ordre lexicographique (x,y) sur les indices de points, pour qsort().
+static point *POINTS; // points utilisés par fcmp_xy()
+static int fcmp_xy(const void *i, const void *j) {
+  point const p = POINTS[*(int*)i], q = POINTS[*(int*)j];
+  if(p.x != q.x) return (p.x > q.x) - (p.x < q.x);
+  return (p.y > q.y) - (p.y < q.y);
+}
+
+// Produit vectoriel (b-a)x(c-a), >0 ssi a,b,c tournent à gauche.
+static inline double cross(point a, point b, point c) {
+  return (b.x-a.x)*(c.y-a.y) - (b.y-a.y)*(c.x-a.x);
+}
+
+// Calcule dans H les sommets de l'enveloppe convexe de V (algorithme
+// de la chaîne monotone d'Andrew) et renvoie leur nombre. Il faut H
+// de taille n+1.
+static int hull(point *V, int n, int *H) {
+  int *I = malloc(n * sizeof(int));
+  for(int i=0; i<n; i++) I[i] = i;
+  POINTS = V;
+  qsort(I, n, sizeof(int), fcmp_xy);
+  int h = 0;
+  for(int i=0; i<n; i++){ // partie basse
+    while(h >= 2 && cross(V[H[h-2]], V[H[h-1]], V[I[i]]) <= 0) h--;
+    H[h++] = I[i];
+  }
+  for(int i=n-2, b=h+1; i>=0; i--){ // partie haute
+    while(h >= b && cross(V[H[h-2]], V[H[h-1]], V[I[i]]) <= 0) h--;
+    H[h++] = I[i];
+  }
+  free(I);
+  return h-1; // le dernier point est le premier
+}
+
+// Met à jour la clé de u dans Q si l'insérer sur l'arête a-c ou c-b,
+// nouvelles arêtes de la tournée, coûte moins que key[u].
+static void relax(tour *T, heap_min Q, double *key, int *at, int *to, int u, int a, int c, int b) {
+  if(T->in[u]) return;
+  double const c1 = cost(T->V, a, u, c), c2 = cost(T->V, c, u, b);
+  if(c1 >= key[u] && c2 >= key[u]) return;
+  if(c1 <= c2) key[u] = c1, at[u] = a, to[u] = c;
+  else key[u] = c2, at[u] = c, to[u] = b;
+  heap_min_add(Q, key[u], u);
+}
+
+double tsp_hull_insertion(point *V, int n, int *P) {
+  // Part de l'enveloppe convexe, puis insère à chaque étape le point
+  // dont le coût d'insertion est le plus petit. Pour chaque point c,
+  // key[c] est son coût d'insertion minimum sur une arête candidate
+  // (cf. candidate()), entre at[c] et son successeur to[c] au moment
+  // du calcul. Une insertion de c entre a et b ne fait que:
+  // - créer les arêtes a-c et c-b: les coûts des voisins de a, b et c
+  //   et des points à distance au plus r = max(d(a,c),d(c,b)) de c
+  //   sont mis à jour et ajoutés à Q si elles les améliorent;
+  // - détruire l'arête a-b: les points dont la meilleure arête était
+  //   a-b ont une clé devenue trop petite. Ils ne sont recalculés que
+  //   lorsqu'ils sortent du tas.
+  // Les clés de départ et les clés recalculées essayent aussi les
+  // arêtes des INS_K points de la tournée les plus proches (cf.
+  // buckets_nearest()), ou toutes celles de l'enveloppe si elle a au
+  // plus HULL_ALL points, pour qu'aucun point n'ait une clé infinie.
+  if(n < 4){
+    for(int i=0; i<n; i++) P[i] = i;
+    return value(V, n, P);
+  }
+
+  tour T = tour_create(V, n, true);
+  buckets B = buckets_create(V, n, false); // points de la tournée
+  buckets U = buckets_create(V, n, true);  // points hors de la tournée
+  int *R = NULL, size = 0; // points proches de c, pour buckets_range()
+  int *at = malloc(n * sizeof(int));
+  int *to = malloc(n * sizeof(int));
+  double *key = malloc(n * sizeof(double));
+  int *H = malloc((n+1) * sizeof(int));
+  heap_min Q = heap_min_create(n);
+
+  int h = hull(V, n, H);
+  if(h < 2) H[0] = 0, H[1] = 1, h = 2; // points tous confondus
+  for(int i=0; i<h; i++){
+    T.next[H[i]] = H[(i+1)%h];
+    T.prev[H[(i+1)%h]] = H[i];
+    T.in[H[i]] = true;
+    buckets_add(&B, H[i]);
+    buckets_remove(&U, H[i]);
+  }
+  int const s = H[0];
+
+  for(int c=0; c<n; c++){
+    if(T.in[c]) continue;
+    if(h <= HULL_ALL) key[c] = candidate(&T, c, H, h, &at[c]);
+    else{
+      int L[INS_K];
+      int const l = buckets_nearest(&B, V[c], INS_K, L);
+      key[c] = candidate(&T, c, L, l, &at[c]);
+    }
+    to[c] = T.next[at[c]];
+    heap_min_add(Q, key[c], c);
+  }
+
+  double k;
+  int c, m = h;
+  while(m < n && heap_min_pop(Q, &k, &c)){
+    if(T.in[c] || k != key[c]) continue; // entrée périmée
+    if(T.next[at[c]] != to[c]){ // l'arête at[c]-to[c] n'existe plus
+      int L[INS_K];
+      int const l = buckets_nearest(&B, V[c], INS_K, L);
+      key[c] = candidate(&T, c, L, l, &at[c]);
+      to[c] = T.next[at[c]];
+      heap_min_add(Q, key[c], c);
+      continue;
+    }
+    int const a = at[c], b = to[c];
+    insert(&T, a, c);
+    buckets_add(&B, c);
+    buckets_remove(&U, c);
+    m++;
+
+    int const x[3] = { a, b, c };
+    for(int j=0; j<3; j++)
+      for(int i=T.first[x[j]]; i<T.first[x[j]+1]; i++)
+        relax(&T, Q, key, at, to, T.adj[i], a, c, b);
+    double const r = fmax(dist(V[a], V[c]), dist(V[c], V[b]));
+    int const l = buckets_range(&U, V[c], r, &R, &size);
+    for(int i=0; i<l; i++) relax(&T, Q, key, at, to, R[i], a, c, b);
+  }
+
+  double const w = extract(V, n, T.next, s, P);
+  heap_min_destroy(Q);
+  free(H);
+  free(key);
+  free(to);
+  free(at);
+  free(R);
+  buckets_free(&U);
+  buckets_free(&B);
+  tour_free(&T);
+  return w;
+}
+
+double tsp_farthest_insertion(point *V, int n, int *P) {
+  // Insère à chaque étape le point c le plus éloigné de la tournée,
+  // là où il coûte le moins parmi les arêtes candidates et celles des
+  // INS_K points de la tournée les plus proches de c. La clé key[c]
+  // est le carré de la distance de c à un point de la tournée. Les
+  // clés ne font que diminuer et ne sont pas mises à jour lors des
+  // insertions: elles sont trop hautes dans le tas max. Quand c sort
+  // du tas on cherche le point de la tournée le plus proche, et on
+  // remet c dans Q si sa clé a diminué. Sinon c est bien le plus
+  // éloigné.
+  if(n < 4){
+    for(int i=0; i<n; i++) P[i] = i;
+    return value(V, n, P);
+  }
+
+  tour T = tour_create(V, n, true);
+  buckets B = buckets_create(V, n, false); // points de la tournée
+  double *key = malloc(n * sizeof(double));
+  heap_max Q = heap_max_create(n);
+
+  // tournée de départ: 0 et le point le plus éloigné de 0
+  int b = 1;
+  for(int c=1; c<n; c++){
+    key[c] = dist2(V[0], V[c]);
+    if(key[c] > key[b]) b = c;
+  }
+  T.next[0] = T.prev[0] = b, T.next[b] = T.prev[b] = 0;
+  T.in[0] = T.in[b] = true;
+  buckets_add(&B, 0);
+  buckets_add(&B, b);
+
+  for(int c=0; c<n; c++){
+    if(T.in[c]) continue;
+    double const d = dist2(V[b], V[c]);
+    if(d < key[c]) key[c] = d;
+    heap_max_add(Q, key[c], c);
+  }
+
+  double k;
+  int c, m = 2;
+  while(m < n && heap_max_pop(Q, &k, &c)){
+    if(T.in[c] || k != key[c]) continue; // entrée périmée
+    int L[INS_K], a;
+    buckets_nearest(&B, V[c], 1, L);
+    double const d = dist2(V[c], V[L[0]]);
+    if(d < key[c]){
+      key[c] = d;
+      heap_max_add(Q, d, c);
+      continue;
+    }
+    int const l = buckets_nearest(&B, V[c], INS_K, L);
+    candidate(&T, c, L, l, &a);
+    insert(&T, a, c);
+    buckets_add(&B, c);
+    m++;
+  }
+
+  double const w = extract(V, n, T.next, 0, P);
+  heap_max_destroy(Q);
+  free(key);
+  buckets_free(&B);
+  tour_free(&T);
+  return w;
+}
+
+// Renvoie le point hors de la tournée le plus proche de t: le premier
+// de la liste N[t] de ses k plus proches voisins qui n'est pas dans la
+// tournée ou, s'ils y sont tous, le plus proche de la grille B des
+// points restants.
+static int closest(tour *T, buckets *B, int *N, int k, int t) {
+  for(int i=0; i<k; i++)
+    if(!T->in[N[t*k+i]]) return N[t*k+i];
+  int c;
+  buckets_nearest(B, T->V[t], 1, &c);
+  return c;
+}
+
+double tsp_nearest_insertion(point *V, int n, int *P) {
+  // Insère à chaque étape le point c le plus proche de la tournée,
+  // juste avant ou juste après le point t de la tournée le plus proche
+  // de c. Les points sont donc insérés dans l'ordre de Prim. Le tas
+  // contient les points t de la tournée, de clé key[t] = carré de la
+  // distance de t au point near[t] hors de la tournée le plus proche
+  // (cf. closest()). Si near[t] a été inséré entre-temps,
+  // la clé de t n'est qu'une borne inférieure: on recalcule near[t]
+  // quand t sort du tas, et on le remet dans Q.
+  if(n < 4){
+    for(int i=0; i<n; i++) P[i] = i;
+    return value(V, n, P);
+  }
+
+  tour T = tour_create(V, n, false);
+  buckets B = buckets_create(V, n, true); // points hors de la tournée
+  int const k = (n-1 < INS_K)? n-1 : INS_K;
+  int *N = neighbors(V, n, k);
+  int *near = malloc(n * sizeof(int));
+  double *key = malloc(n * sizeof(double));
+  heap_min Q = heap_min_create(n);
+
+  T.next[0] = T.prev[0] = 0; // tournée de départ: 0 seul
+  T.in[0] = true;
+  buckets_remove(&B, 0);
+  near[0] = closest(&T, &B, N, k, 0);
+  key[0] = dist2(V[0], V[near[0]]);
+  heap_min_add(Q, key[0], 0);
+
+  int t, m = 1;
+  while(m < n && heap_min_pop(Q, NULL, &t)){
+    int const c = near[t];
+    if(T.in[c]){ // clé périmée
+      near[t] = closest(&T, &B, N, k, t);
+      key[t] = dist2(V[t], V[near[t]]);
+      heap_min_add(Q, key[t], t);
+      continue;
+    }
+    int a = t; // avant ou après t
+    int const p = T.prev[a], b = T.next[a];
+    if(dist(V[p], V[c]) - dist(V[p], V[a]) < dist(V[c], V[b]) - dist(V[a], V[b])) a = p;
+    insert(&T, a, c);
+    buckets_remove(&B, c);
+    if(++m == n) break; // plus de point hors de la tournée
+    int const x[2] = { t, c };
+    for(int j=0; j<2; j++){
+      near[x[j]] = closest(&T, &B, N, k, x[j]);
+      key[x[j]] = dist2(V[x[j]], V[near[x[j]]]);
+      heap_min_add(Q, key[x[j]], x[j]);
+    }
+  }
+
+  double const w = extract(V, n, T.next, 0, P);
+  heap_min_destroy(Q);
+  free(key);
+  free(near);
+  free(N);
+  buckets_free(&B);
+  tour_free(&T);
+  return w;
+}
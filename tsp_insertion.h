@@ -0,0 +1,22 @@
+#ifndef TSP_INSERTION_H
+#define TSP_INSERTION_H
+
+#include "core.h"
+
+// Heuristiques d'insertion. Chaque fonction remplit la tournée P et
+// renvoie sa valeur, comme tsp_greedy(). Elles peuvent servir de
+// tournée de départ pour tsp_flip_from().
+
+// Enveloppe convexe puis insertion la moins chère, parmi les arêtes
+// proches de chaque point.
+double tsp_hull_insertion(point *V, int n, int *P);
+
+// Insère le point le plus éloigné de la tournée, là où il coûte le
+// moins parmi les arêtes proches de lui.
+double tsp_farthest_insertion(point *V, int n, int *P);
+
+// Insère le point le plus proche de la tournée, juste avant ou juste
+// après le point de la tournée dont il est le plus proche.
+double tsp_nearest_insertion(point *V, int n, int *P);
+
+#endif /* TSP_INSERTION_H */
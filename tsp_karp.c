@@ -0,0 +1,210 @@
+#include "core.h"
+#include "tsp_brute_force.h"
+#include "tsp_heuristic.h"
+#include "tsp_sfc.h"
+#include "tsp_karp.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+//
+//  TSP - PARTITIONNEMENT DE KARP
+//
+//  1. Les indices des points sont découpés récursivement par la
+//     médiane de la plus grande dimension de leur boîte englobante,
+//     jusqu'à obtenir des cases d'au plus m points.
+//  2. Chaque case est résolue indépendamment par un pool de threads
+//     qui se partagent les cases (compteur atomique): force brute pour
+//     les toutes petites cases, greedy-edge + 2-opt + Or-opt sinon.
+//  3. Les cases sont enchaînées selon l'ordre de Hilbert de leurs
+//     centres. Chaque sous-tournée est ouverte au point le plus proche
+//     de la fin de la précédente, et parcourue dans le sens qui la fait
+//     finir vers la case suivante.
+//  4. Un 2-opt restreint aux points ayant un voisin dans une autre case
+//     répare les frontières, suivi d'une passe d'Or-opt.
+//
+
+#define KARP_M 2000    // taille maximale d'une case pour tsp_partition()
+#define KARP_BRUTE 8   // cases résolues exactement par force brute
+#define KARP_K 8       // nombre de voisins candidats
+
+// Une case: les points I[a..b[ (indices dans V).
+typedef struct {
+  int a, b;
+} box;
+
+// Données partagées par les threads.
+typedef struct {
+  point *V;
+  int *I;          // indices des points, regroupés par case
+  box *B;          // les cases, dans l'ordre de parcours
+  int nb;          // nombre de cases
+  atomic_int next; // prochaine case à résoudre
+  context *ctx;
+} pool;
+
+// Échange I[i] et I[j].
+static inline void swap(int *I, int i, int j) {
+  int const t = I[i];
+  I[i] = I[j], I[j] = t;
+}
+
+// Coordonnée x (dim=0) ou y (dim=1) du point V[u].
+static inline double coord(point *V, int u, int dim) {
+  return dim? V[u].y : V[u].x;
+}
+
+// Réarrange I[a..b[ pour que I[m] soit à sa place dans l'ordre selon
+// la dimension dim, les plus petits avant et les plus grands après
+// (sélection rapide, O(b-a) en moyenne). Les pivots sont tirés avec
+// rand_r(seed), sans toucher au générateur global de random().
+static void median(point *V, int *I, int a, int b, int m, int dim, unsigned *seed) {
+  while(b - a > 1){
+    swap(I, a + rand_r(seed) % (b-a), b-1); // pivot aléatoire en fin
+    double const p = coord(V, I[b-1], dim);
+    int s = a;
+    for(int i=a; i<b-1; i++)
+      if(coord(V, I[i], dim) < p) swap(I, i, s++);
+    swap(I, s, b-1);
+    if(s == m) return;
+    if(m < s) b = s;
+    else a = s+1;
+  }
+}
+
+// Découpe I[a..b[ en cases d'au plus m points, ajoutées à B[*nb].
+static void split(point *V, int *I, int a, int b, int m, box *B, int *nb, unsigned *seed) {
+  if(b - a <= m){
+    B[(*nb)++] = (box){ a, b };
+    return;
+  }
+  double xmin = DBL_MAX, xmax = -DBL_MAX, ymin = DBL_MAX, ymax = -DBL_MAX;
+  for(int i=a; i<b; i++){
+    xmin = fmin(xmin, V[I[i]].x); xmax = fmax(xmax, V[I[i]].x);
+    ymin = fmin(ymin, V[I[i]].y); ymax = fmax(ymax, V[I[i]].y);
+  }
+  int const mid = (a + b) / 2;
+  median(V, I, a, b, mid, (ymax-ymin > xmax-xmin), seed);
+  split(V, I, a, mid, m, B, nb, seed);
+  split(V, I, mid, b, m, B, nb, seed);
+}
+
+// Remplace I[a..b[ par une bonne tournée de ces points.
+static void solve(point *V, int *I, int a, int b, context *ctx) {
+  int const n = b - a;
+  point *W = malloc(n * sizeof(point)); // copie locale des points
+  int *Q = malloc(n * sizeof(int));
+  for(int i=0; i<n; i++) W[i] = V[I[a+i]];
+  if(n <= KARP_BRUTE){
+    tsp_brute_force_opt(W, n, Q, ctx);
+  }else{
+    tsp_greedy_edge(W, n, Q);
+    int const k = (n-1 < KARP_K)? n-1 : KARP_K;
+    int *N = neighbors(W, n, k);
+    two_opt(W, n, Q, N, k, NULL, ctx);
+    or_opt(W, n, Q, N, k, 3, ctx);
+    free(N);
+  }
+  for(int i=0; i<n; i++) Q[i] = I[a+Q[i]];
+  memcpy(I+a, Q, n * sizeof(int));
+  free(Q);
+  free(W);
+}
+
+static void *worker(void *arg) {
+  pool *T = arg;
+  int c;
+  while((c = atomic_fetch_add(&T->next, 1)) < T->nb)
+    solve(T->V, T->I, T->B[c].a, T->B[c].b, T->ctx);
+  return NULL;
+}
+
+double tsp_karp(point *V, int n, int *P, int m, int threads, context *ctx) {
+  if(m < 3) m = 3;
+  if(threads < 1) threads = 1;
+  if(n <= m){ // une seule case
+    for(int i=0; i<n; i++) P[i] = i;
+    solve(V, P, 0, n, ctx);
+    return value(V, n, P);
+  }
+
+  // les points sont renumérotés pour que les accès de la réparation
+  // finale restent locaux
+  int *id = renumber(V, n, threads);
+
+  // 1. découpage
+  int *I = malloc(n * sizeof(int));
+  for(int i=0; i<n; i++) I[i] = i;
+  box *B = malloc((2*n/m + 2) * sizeof(box));
+  int nb = 0;
+  unsigned seed = 1; // découpage reproductible
+  split(V, I, 0, n, m, B, &nb, &seed);
+
+  // ordre de parcours des cases: courbe de Hilbert sur leurs centres
+  point *C = malloc(nb * sizeof(point));
+  for(int c=0; c<nb; c++){
+    C[c] = (point){ 0, 0 };
+    for(int i=B[c].a; i<B[c].b; i++) C[c].x += V[I[i]].x, C[c].y += V[I[i]].y;
+    C[c].x /= B[c].b - B[c].a;
+    C[c].y /= B[c].b - B[c].a;
+  }
+  int *order = malloc(nb * sizeof(int));
+  hilbert_order(C, nb, order, 1);
+
+  // 2. résolution des cases en parallèle
+  pool T = { .V = V, .I = I, .B = B, .nb = nb, .ctx = ctx };
+  atomic_init(&T.next, 0);
+  pthread_t *tid = malloc(threads * sizeof(pthread_t));
+  for(int t=0; t<threads-1; t++) pthread_create(&tid[t], NULL, worker, &T);
+  worker(&T);
+  for(int t=0; t<threads-1; t++) pthread_join(tid[t], NULL);
+  free(tid);
+
+  // 3. recollage: la sous-tournée de la case c (cycle I[a..b[) est
+  // ouverte au point le plus proche de la fin du chemin courant
+  int *cell = malloc(n * sizeof(int)); // cell[u] = case du point u
+  int t = 0;
+  for(int o=0; o<nb; o++){
+    int const c = order[o], a = B[c].a, len = B[c].b - a;
+    for(int i=a; i<a+len; i++) cell[I[i]] = c;
+    int s = 0;
+    if(t > 0){
+      double dmin = DBL_MAX;
+      for(int i=0; i<len; i++){
+        double const d = dist(V[P[t-1]], V[I[a+i]]);
+        if(d < dmin) dmin = d, s = i;
+      }
+    }
+    // sens: la fin (voisin de s dans le cycle) la plus proche de la
+    // case suivante
+    int dir = 1;
+    if(o+1 < nb){
+      point const nc = C[order[o+1]];
+      if(dist(V[I[a+(s+1)%len]], nc) < dist(V[I[a+(s-1+len)%len]], nc)) dir = -1;
+    }
+    for(int i=0; i<len; i++) P[t++] = I[a + ((s + dir*i) % len + len) % len];
+  }
+
+  // 4. réparation des frontières
+  int *N = neighbors(V, n, KARP_K);
+  bool *active = malloc(n * sizeof(bool));
+  for(int u=0; u<n; u++){
+    active[u] = false;
+    for(int i=0; i<KARP_K; i++) active[u] |= (cell[N[u*KARP_K+i]] != cell[u]);
+  }
+  two_opt(V, n, P, N, KARP_K, active, ctx);
+  or_opt(V, n, P, N, KARP_K, 1, ctx);
+
+  free(active);
+  free(N);
+  free(cell);
+  free(order);
+  free(C);
+  free(B);
+  free(I);
+  restore(V, n, P, id);
+  return value(V, n, P);
+}
+
+double tsp_partition(point *V, int n, int *P) {
+  return tsp_karp(V, n, P, KARP_M, sysconf(_SC_NPROCESSORS_ONLN), NULL);
+}
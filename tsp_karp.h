@@ -0,0 +1,19 @@
+#ifndef TSP_KARP_H
+#define TSP_KARP_H
+
+#include "core.h"
+#include "tsp_context.h"
+
+// Partitionnement géométrique de Karp: découpe V en cases d'au plus m
+// points par des coupes médianes (k-d), résout chaque case sur
+// "threads" threads, recolle les sous-tournées puis répare les
+// frontières par recherche locale. Si ctx expire, les recherches
+// locales s'arrêtent mais toutes les cases sont construites. Renvoie
+// la valeur de la tournée P.
+double tsp_karp(point *V, int n, int *P, int m, int threads, context *ctx);
+
+// Comme tsp_karp() avec des cases de KARP_M points et un thread par
+// processeur.
+double tsp_partition(point *V, int n, int *P);
+
+#endif /* TSP_KARP_H */
@@ -1,9 +1,44 @@
 #include "tools.h"
+#include "tsp_context.h"
+#include <pthread.h>
 
 #include "tsp_brute_force.h"
 #include "tsp_prog_dyn.h"
 #include "tsp_heuristic.h"
 #include "tsp_mst.h"
+#include "tsp_insertion.h"
+#include "tsp_sfc.h"
+#include "tsp_karp.h"
+#include "tsp_multilevel.h"
+#include "tsp_multistart.h"
+#include "tsp_sa.h"
+#include "tsp_genetic.h"
+#include "tsp_aco.h"
+#include "tsp_gls.h"
+#include "tsp_bound.h"
+
+static pthread_t ui;          // thread de la fenêtre
+static bool window_open = false;
+
+// Fonction de progression des solveurs: dessine le chemin ou la
+// tournée courante et annule le calcul si 'q' a été pressée. Seul le
+// thread de la fenêtre dessine et gère les évènements.
+static bool render(point *V, int n, int *P, int k, void *arg) {
+  if (!pthread_equal(pthread_self(), ui)) return running;
+  if (P == NULL) handleEvent(false);
+  else if (k < n) drawPath(V, n, P, k);
+  else drawTour(V, n, P);
+  return running;
+}
+
+// Contexte passé aux solveurs: sans limite, avec l'affichage de leur
+// progression (au plus 50 images par seconde) si la fenêtre est ouverte.
+static context *display(void) {
+  static context C;
+  ctx_init(&C, 0, 0);
+  if (window_open) ctx_progress(&C, render, NULL, 50);
+  return &C;
+}
 
 int main(int argc, char *argv[]) {
 
@@ -26,13 +61,15 @@ int main(int argc, char *argv[]) {
   P[0] = -1; // permutation qui ne sera pas dessinée par drawTour()
 
   init_SDL_OpenGL();    // initialisation avant de dessiner
+  ui = pthread_self();
+  window_open = true;
   drawTour(V, n, NULL); // dessine seulement les points
 
 #ifdef TSP_BRUTE_FORCE_H
   printf("*** brute-force ***\n");
   running = true; // force l'exécution
   TopChrono(1);   // départ du chrono 1
-  printf("value: %g\n", tsp_brute_force(V, n, P));
+  printf("value: %g\n", tsp_brute_force(V, n, P, display()));
   printf("running time: %s\n", TopChrono(1)); // durée
   printf("waiting for a key ... ");
   fflush(stdout);
@@ -46,7 +83,7 @@ int main(int argc, char *argv[]) {
   printf("*** brute-force optimisé ***\n");
   running = true; // force l'exécution
   TopChrono(1);   // départ du chrono 1
-  printf("value: %g\n", tsp_brute_force_opt(V, n, P));
+  printf("value: %g\n", tsp_brute_force_opt(V, n, P, display()));
   printf("running time: %s\n", TopChrono(1)); // durée
   printf("waiting for a key ... ");
   fflush(stdout);
@@ -65,7 +102,7 @@ int main(int argc, char *argv[]) {
   while (running) {   // affiche le résultat et attend (q pour sortir)
     if (redraw){      // recalcule si nécessaire
       TopChrono(1);   // départ du chrono 1
-      printf("value: %g\n", tsp_brute_force_opt(V, n, P));
+      printf("value: %g\n", tsp_brute_force_opt(V, n, P, display()));
       printf("running time: %s\n", TopChrono(1)); // durée
       printf("waiting for a key ... ");
       fflush(stdout);
@@ -83,7 +120,7 @@ int main(int argc, char *argv[]) {
   while (running) {   // affiche le résultat et attend (q pour sortir)
     if (redraw){      // recalcule si nécessaire
       TopChrono(1);   // départ du chrono 1
-      printf("value: %g\n", tsp_prog_dyn(V, n, P));
+      printf("value: %g\n", tsp_prog_dyn(V, n, P, display()));
       printf("running time: %s\n", TopChrono(1)); // durée
       printf("waiting for a key ... ");
       fflush(stdout);
@@ -94,7 +131,7 @@ int main(int argc, char *argv[]) {
   /*
   running = true; // force l'exécution
   TopChrono(1);   // départ du chrono 1
-  printf("value: %g\n", tsp_prog_dyn(V, n, P));
+  printf("value: %g\n", tsp_prog_dyn(V, n, P, display()));
   printf("running time: %s\n", TopChrono(1)); // durée
   printf("waiting for a key ... ");
   fflush(stdout);
@@ -104,6 +141,20 @@ int main(int argc, char *argv[]) {
     handleEvent(true); // attend un évènement (=true) ou pas
   }
   */
+
+  /* calcul par étapes, repris depuis le fichier "dp.ckpt" s'il existe */
+  /*
+  checkpoint K;
+  ckpt_start(&K, "dp.ckpt");
+  dp_state *E = dp_load(V, n, "dp.ckpt");
+  if (E == NULL) E = dp_create(V, n);
+  running = true; // force l'exécution
+  while (!dp_step(E, 1 << 20) && running) dp_checkpoint(E, &K);
+  printf("value: %g\n", dp_tour(E, P));
+  ckpt_wait(&K); // fin de l'écriture avant de libérer la table
+  ckpt_stop(&K);
+  dp_free(E);
+  */
   printf("\n");
 #endif
 
@@ -111,7 +162,7 @@ int main(int argc, char *argv[]) {
   printf("*** flip ***\n");
   running = true; // force l'exécution
   TopChrono(1);   // départ du chrono 1
-  printf("value: %g\n", tsp_flip(V, n, P));
+  printf("value: %g\n", tsp_flip(V, n, P, display()));
   printf("running time: %s\n", TopChrono(1)); // durée
   printf("waiting for a key ... ");
   fflush(stdout);
@@ -139,9 +190,215 @@ int main(int argc, char *argv[]) {
     update = (first_flip(V, n, P) == 0.0); // force l'affichage si pas de flip
   }
   printf("\n");
+
+  printf("*** greedy-edge + flip ***\n");
+  running = true; // force l'exécution
+  TopChrono(1);   // départ du chrono 1
+  printf("value: %g\n", tsp_greedy_edge(V, n, P));
+  printf("value after flip: %g\n", tsp_flip_from(V, n, P, tsp_greedy_edge, display()));
+  printf("running time: %s\n", TopChrono(1)); // durée
+  printf("waiting for a key ... ");
+  fflush(stdout);
+  update = true;    // force l'affichage
+  while (running) { // affiche le résultat et attend (q pour sortir)
+    if (handleEvent(update)) tsp_flip_from(V, n, P, tsp_greedy_edge, display());
+    drawTour(V, n, P); // dessine la tournée
+  }
+  printf("\n");
   
 #endif
 
+#ifdef TSP_INSERTION_H
+  printf("*** insertion ***\n");
+  running = true; // force l'exécution
+  TopChrono(1);   // départ du chrono 1
+  printf("value (nearest): %g\n", tsp_nearest_insertion(V, n, P));
+  printf("value (farthest): %g\n", tsp_farthest_insertion(V, n, P));
+  printf("value (convex hull + cheapest): %g\n", tsp_hull_insertion(V, n, P));
+  printf("running time: %s\n", TopChrono(1)); // durée
+  printf("waiting for a key ... ");
+  fflush(stdout);
+  update = true;    // force l'affichage
+  while (running) { // affiche le résultat et attend (q pour sortir)
+    if (handleEvent(update)) tsp_hull_insertion(V, n, P);
+    drawTour(V, n, P); // dessine la tournée
+  }
+  printf("\n");
+#endif
+
+#ifdef TSP_SFC_H
+  printf("*** hilbert + or-opt ***\n");
+  running = true; // force l'exécution
+  TopChrono(1);   // départ du chrono 1
+  printf("value: %g\n", tsp_hilbert(V, n, P));
+  printf("running time: %s\n", TopChrono(1)); // durée
+  TopChrono(1); // greedy-edge sur les points renumérotés, pour comparer
+  printf("value (renumbered greedy-edge): %g\n", tsp_renumbered(V, n, P, tsp_greedy_edge));
+  printf("running time: %s\n", TopChrono(1)); // durée
+  printf("waiting for a key ... ");
+  fflush(stdout);
+  update = true;    // force l'affichage
+  while (running) { // affiche le résultat et attend (q pour sortir)
+    if (handleEvent(update)) tsp_hilbert(V, n, P);
+    drawTour(V, n, P); // dessine la tournée
+  }
+  printf("\n");
+#endif
+
+#ifdef TSP_KARP_H
+  printf("*** karp partitioning ***\n");
+  running = true; // force l'exécution
+  TopChrono(1);   // départ du chrono 1
+  printf("value: %g\n", tsp_partition(V, n, P));
+  printf("running time: %s\n", TopChrono(1)); // durée
+  printf("waiting for a key ... ");
+  fflush(stdout);
+  update = true;    // force l'affichage
+  while (running) { // affiche le résultat et attend (q pour sortir)
+    if (handleEvent(update)) tsp_partition(V, n, P);
+    drawTour(V, n, P); // dessine la tournée
+  }
+  printf("\n");
+#endif
+
+#ifdef TSP_MULTILEVEL_H
+  printf("*** multilevel ***\n");
+  running = true; // force l'exécution
+  TopChrono(1);   // départ du chrono 1
+  printf("value: %g\n", tsp_multilevel(V, n, P, display()));
+  printf("running time: %s\n", TopChrono(1)); // durée
+  context deadline; // meilleure tournée obtenue en 200 ms
+  ctx_init(&deadline, 0.2, 0);
+  printf("value (200 ms): %g\n", tsp_multilevel(V, n, P, &deadline));
+  printf("running time: %s\n", TopChrono(1)); // durée
+  printf("waiting for a key ... ");
+  fflush(stdout);
+  update = true;    // force l'affichage
+  while (running) { // affiche le résultat et attend (q pour sortir)
+    if (handleEvent(update)) tsp_multilevel(V, n, P, display());
+    drawTour(V, n, P); // dessine la tournée
+  }
+  printf("\n");
+#endif
+
+#ifdef TSP_MULTISTART_H
+  printf("*** multi-start ***\n");
+  running = true; // force l'exécution
+  TopChrono(1);   // départ du chrono 1
+  printf("value: %g\n", tsp_restarts(V, n, P));
+  printf("running time: %s\n", TopChrono(1)); // durée
+  printf("waiting for a key ... ");
+  fflush(stdout);
+  update = true;    // force l'affichage
+  while (running) { // affiche le résultat et attend (q pour sortir)
+    if (handleEvent(update)) tsp_restarts(V, n, P);
+    drawTour(V, n, P); // dessine la tournée
+  }
+  printf("\n");
+#endif
+
+#ifdef TSP_SA_H
+  printf("*** simulated annealing ***\n");
+  running = true; // force l'exécution
+  TopChrono(1);   // départ du chrono 1
+  printf("value: %g\n", tsp_annealing(V, n, P));
+  printf("running time: %s\n", TopChrono(1)); // durée
+  printf("waiting for a key ... ");
+  fflush(stdout);
+  update = true;    // force l'affichage
+  while (running) { // affiche le résultat et attend (q pour sortir)
+    if (handleEvent(update)) tsp_annealing(V, n, P);
+    drawTour(V, n, P); // dessine la tournée
+  }
+  printf("\n");
+#endif
+
+#ifdef TSP_GENETIC_H
+  printf("*** genetic (EAX) ***\n");
+  running = true; // force l'exécution
+  TopChrono(1);   // départ du chrono 1
+  printf("value: %g\n", tsp_eax(V, n, P));
+  printf("running time: %s\n", TopChrono(1)); // durée
+  printf("waiting for a key ... ");
+  fflush(stdout);
+  update = true;    // force l'affichage
+  while (running) { // affiche le résultat et attend (q pour sortir)
+    if (handleEvent(update)) tsp_eax(V, n, P);
+    drawTour(V, n, P); // dessine la tournée
+  }
+  printf("\n");
+#endif
+
+#ifdef TSP_ACO_H
+  printf("*** ant colony ***\n");
+  running = true; // force l'exécution
+  TopChrono(1);   // départ du chrono 1
+  printf("value: %g\n", tsp_ants(V, n, P));
+  printf("running time: %s\n", TopChrono(1)); // durée
+  printf("waiting for a key ... ");
+  fflush(stdout);
+  update = true;    // force l'affichage
+  while (running) { // affiche le résultat et attend (q pour sortir)
+    if (handleEvent(update)) tsp_ants(V, n, P);
+    drawTour(V, n, P); // dessine la tournée
+  }
+  printf("\n");
+#endif
+
+#ifdef TSP_GLS_H
+  printf("*** guided local search ***\n");
+  running = true; // force l'exécution
+  TopChrono(1);   // départ du chrono 1
+  printf("value: %g\n", tsp_guided(V, n, P));
+  printf("running time: %s\n", TopChrono(1)); // durée
+  printf("waiting for a key ... ");
+  fflush(stdout);
+  update = true;    // force l'affichage
+  while (running) { // affiche le résultat et attend (q pour sortir)
+    if (handleEvent(update)) tsp_guided(V, n, P);
+    drawTour(V, n, P); // dessine la tournée
+  }
+  printf("\n");
+
+  printf("*** tabu search ***\n");
+  running = true; // force l'exécution
+  TopChrono(1);   // départ du chrono 1
+  printf("value: %g\n", tsp_tabu_search(V, n, P));
+  printf("running time: %s\n", TopChrono(1)); // durée
+  printf("waiting for a key ... ");
+  fflush(stdout);
+  update = true;    // force l'affichage
+  while (running) { // affiche le résultat et attend (q pour sortir)
+    if (handleEvent(update)) tsp_tabu_search(V, n, P);
+    drawTour(V, n, P); // dessine la tournée
+  }
+  printf("\n");
+#endif
+
+#ifdef TSP_BOUND_H
+  printf("*** held-karp bound ***\n");
+  running = true; // force l'exécution
+  TopChrono(1);   // départ du chrono 1
+  if (P[0] < 0) tsp_greedy_edge(V, n, P); // il faut une tournée (majorant)
+  double *pi = malloc(n * sizeof(*pi)); // potentiels
+  double lb = held_karp(V, n, P, pi, 100 + n/10, display());
+  printf("lower bound: %g, tour: %g, gap: %.3f%%\n", lb, value(V, n, P),
+         100 * (value(V, n, P) / lb - 1));
+  printf("running time: %s\n", TopChrono(1)); // durée
+  printf("waiting for a key ... ");
+  fflush(stdout);
+  graph H = createGraph(n); // 1-arbre des meilleurs potentiels
+  one_tree(V, n, pi, H);
+  update = true;         // force l'affichage
+  while (running) {      // affiche le résultat et attend (q pour sortir)
+    drawGraph(V, n, P, H); // dessine la tournée et le 1-arbre
+    handleEvent(true);   // attend un évènement (=true) ou pas
+  }
+  freeGraph(H);
+  free(pi);
+  printf("\n");
+#endif
+
 #ifdef TSP_MST_H
   printf("*** mst ***\n");
   running = true; // force l'exécution
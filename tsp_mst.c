@@ -1,4 +1,4 @@
-#include "tools.h"
+#include "core.h"
 #include "tsp_brute_force.h"
 #include "tsp_mst.h"
 
@@ -142,7 +142,7 @@ double tsp_mst(point *V, int n, int *P, graph T) {
   }
   int nbAjout = 0;
   index = 0;
-  while(nbAjout < n-1 && running){
+  while(nbAjout < n-1){
     edge e = E[index];
     int parentU = Find(e.u, parent);
     int parentV = Find(e.v, parent); 
@@ -150,18 +150,11 @@ double tsp_mst(point *V, int n, int *P, graph T) {
       Union(parentU, parentV, parent, rank);
       addEdge(T, e.u, e.v);
       nbAjout++;
-      //drawGraph(V,n,NULL,T);
-      //SDL_Delay(100);
     }
     index++;   
   }
 
 
-  // option pour le débugage: lorsque vous ajoutez une arête à T vous
-  // pouvez visualiser l'arbre courant avec drawGraph(V,n,NULL,T);
-  // SDL_Delay(500); Ajouter un "&& running" dans votre boucle pour
-  // quiter simplement.
-
   // libère les tableaux devenus inutiles
   free(parent);
   free(rank);
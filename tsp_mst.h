@@ -1,7 +1,7 @@
 #ifndef TSP_MST_H
 #define TSP_MST_H
 
-#include "tools.h"
+#include "core.h"
 
 graph createGraph(int n);
 
@@ -0,0 +1,131 @@
+#include "core.h"
+#include "tsp_brute_force.h"
+#include "tsp_heuristic.h"
+#include "tsp_sfc.h"
+#include "tsp_multilevel.h"
+
+//
+//  TSP - MULTI-NIVEAUX
+//
+//  Contraction: chaque point u non apparié est apparié à son plus
+//  proche voisin v lui aussi libre, et le couple devient un seul point
+//  (le milieu de u-v) du niveau suivant. Un point sans voisin libre
+//  passe tel quel. On recommence jusqu'à ML_MIN
+//  points, ou jusqu'à ce qu'un niveau ne réduise presque plus rien.
+//
+//  Décontraction: chaque point de la tournée d'un niveau est remplacé
+//  par ses un ou deux points du niveau inférieur, dans l'ordre qui
+//  raccorde le mieux le point précédent au suivant. La tournée ainsi
+//  obtenue est raffinée par 2-opt et Or-opt avant de descendre encore.
+//  Contrairement à Walshaw, l'arête u-v d'un couple n'est pas fixée:
+//  elle ne sert qu'à construire la tournée de départ du niveau
+//  inférieur, et le raffinement peut la supprimer.
+//
+
+#define ML_MIN 64  // taille du niveau le plus grossier
+#define ML_K   8   // nombre de voisins candidats
+
+// Un niveau: n points V, et pour le niveau au-dessus de lui, les
+// points fils child[2c], child[2c+1] (-1 si absent) du point c.
+typedef struct {
+  int n;
+  point *V;
+  int *child;
+} level;
+
+// Construit le niveau au-dessus de f.
+static level coarsen(level f) {
+  int const k = (f.n-1 < ML_K)? f.n-1 : ML_K;
+  int *N = neighbors(f.V, f.n, k);
+  bool *matched = calloc(f.n, sizeof(bool));
+  level c = { .n = 0 };
+  c.V = malloc(f.n * sizeof(point));
+  c.child = malloc(2 * f.n * sizeof(int));
+
+  for(int u=0; u<f.n; u++){
+    if(matched[u]) continue;
+    matched[u] = true;
+    int v = -1;
+    for(int i=0; i<k && v<0; i++)
+      if(!matched[N[u*k+i]]) v = N[u*k+i];
+    c.child[2*c.n] = u;
+    c.child[2*c.n+1] = v;
+    if(v < 0) c.V[c.n] = f.V[u];
+    else{
+      matched[v] = true;
+      c.V[c.n] = (point){ (f.V[u].x + f.V[v].x)/2, (f.V[u].y + f.V[v].y)/2 };
+    }
+    c.n++;
+  }
+
+  free(matched);
+  free(N);
+  return c;
+}
+
+// Raffine la tournée T du niveau l, sauf si ctx a expiré.
+static void refine(level l, int *T, context *ctx) {
+  if(ctx_done(ctx)) return;
+  int const k = (l.n-1 < ML_K)? l.n-1 : ML_K;
+  int *N = neighbors(l.V, l.n, k);
+  two_opt(l.V, l.n, T, N, k, NULL, ctx);
+  or_opt(l.V, l.n, T, N, k, 1, ctx);
+  free(N);
+}
+
+double tsp_multilevel(point *V, int n, int *P, context *ctx) {
+  if(n <= ML_MIN){
+    tsp_greedy_edge(V, n, P);
+    if(n >= 5) refine((level){ .n = n, .V = V }, P, ctx);
+    return value(V, n, P);
+  }
+
+  int *id = renumber(V, n, 1); // contraction dans l'ordre de Hilbert
+
+  // contraction
+  int nl = 1, lmax = 8;
+  level *L = malloc(lmax * sizeof(level));
+  L[0] = (level){ .n = n, .V = V, .child = NULL };
+  while(L[nl-1].n > ML_MIN){
+    level const c = coarsen(L[nl-1]);
+    if(nl == lmax) L = realloc(L, (lmax *= 2) * sizeof(level));
+    L[nl++] = c;
+    if(c.n > 0.9 * L[nl-2].n) break; // presque plus d'appariement
+  }
+
+  // niveau le plus grossier
+  int *T = malloc(L[nl-1].n * sizeof(int));
+  tsp_greedy_edge(L[nl-1].V, L[nl-1].n, T);
+  refine(L[nl-1], T, ctx);
+
+  // décontraction
+  for(int l=nl-1; l>0; l--){
+    level const c = L[l], f = L[l-1];
+    int *F = malloc(f.n * sizeof(int));
+    int t = 0;
+    for(int i=0; i<c.n; i++){
+      int x = c.child[2*T[i]], y = c.child[2*T[i]+1];
+      if(y >= 0){ // ordre x,y ou y,x selon les voisins dans la tournée
+        point const p = (t > 0)? f.V[F[t-1]] : c.V[T[c.n-1]];
+        point const q = c.V[T[(i+1) % c.n]];
+        if(dist(p, f.V[y]) + dist(f.V[x], q) < dist(p, f.V[x]) + dist(f.V[y], q)){
+          int const z = x;
+          x = y, y = z;
+        }
+      }
+      F[t++] = x;
+      if(y >= 0) F[t++] = y;
+    }
+    free(T);
+    T = F;
+    refine(f, T, ctx);
+    free(c.V);
+    free(c.child);
+  }
+
+  memcpy(P, T, n * sizeof(int));
+  free(T);
+  free(L);
+  restore(V, n, P, id);
+  return value(V, n, P);
+}
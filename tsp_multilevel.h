@@ -0,0 +1,16 @@
+#ifndef TSP_MULTILEVEL_H
+#define TSP_MULTILEVEL_H
+
+#include "core.h"
+#include "tsp_context.h"
+
+// Solveur multi-niveaux (à la Walshaw): contracte l'instance en
+// appariant des points proches, résout le niveau le plus grossier puis
+// décontracte en raffinant la tournée (2-opt, Or-opt) à chaque niveau.
+// Les couples ne font que guider la tournée de départ de chaque niveau:
+// leurs arêtes ne sont pas fixées pendant le raffinement.
+// Si ctx expire, les niveaux restants sont décontractés sans être
+// raffinés. Renvoie la valeur de la tournée P.
+double tsp_multilevel(point *V, int n, int *P, context *ctx);
+
+#endif /* TSP_MULTILEVEL_H */
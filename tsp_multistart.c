@@ -0,0 +1,194 @@
+#include "core.h"
+#include "tsp_brute_force.h"
+#include "tsp_heuristic.h"
+#include "tsp_sfc.h"
+#include "tsp_multistart.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+//
+//  TSP - MULTI-DÉPARTS PARALLÈLES
+//
+//  Chaque thread enchaîne des départs: une tournée aléatoire (greedy
+//  bruité ou insertion aléatoire) construite dans sa propre tournée de
+//  travail avec son propre générateur (rand_r), puis une recherche
+//  locale. Les threads ne partagent que des données en lecture (V, les
+//  listes de voisins) et trois variables atomiques:
+//
+//  - le nombre de départs déjà lancés;
+//  - best, le numéro du thread qui détient la meilleure tournée;
+//  - val[t], la valeur de la meilleure tournée publiée par le thread t.
+//
+//  Un thread qui trouve une tournée meilleure que val[best] la copie
+//  dans son propre tampon, puis tente de devenir best par un
+//  compare-and-swap, sans verrou. Comme val[t] ne fait que diminuer, un
+//  thread qui gagne le CAS a toujours une tournée meilleure que celle
+//  qu'il remplace. Le tampon d'un thread n'est lu qu'après la fin de
+//  tous les threads.
+//
+
+#define MS_K 8 // nombre de voisins candidats
+
+// Données partagées.
+typedef struct {
+  point *V;
+  int n;
+  int *N;                 // listes de voisins
+  int k;
+  multistart opt;
+  context *ctx;
+  atomic_long started;    // nombre de départs lancés
+  atomic_int best;        // thread de la meilleure tournée, -1 = aucun
+  _Atomic double *val;    // val[t] = meilleure valeur publiée par t
+  int **tour;             // tour[t] = tampon de la meilleure tournée de t
+} engine;
+
+// Un thread.
+typedef struct {
+  engine *E;
+  int id;
+} worker;
+
+// Insertion aléatoire: les points sont insérés dans un ordre aléatoire,
+// chacun à côté de celui de ses voisins candidats déjà insérés qui
+// coûte le moins. Si aucun voisin n'est inséré, on cherche le premier
+// point inséré par un parcours en largeur du graphe des voisins (en
+// moyenne O(n/m) points visités quand m points sont insérés), ou à
+// défaut le dernier inséré. La tournée partielle est une liste chaînée
+// next[], prev[].
+static void random_insertion(point *V, int n, int *P, int *N, int k, unsigned *seed) {
+  int *next = malloc(n * sizeof(int));
+  int *prev = malloc(n * sizeof(int));
+  int *B = malloc(n * sizeof(int));     // file du parcours en largeur
+  int *seen = malloc(n * sizeof(int));  // seen[u] = dernier parcours ayant vu u
+  bool *in = calloc(n, sizeof(bool));
+  for(int i=0; i<n; i++) P[i] = i, seen[i] = -1;
+  for(int i=n-1; i>0; i--){ // mélange de Fisher-Yates
+    int const j = rand_r(seed) % (i+1), t = P[i];
+    P[i] = P[j], P[j] = t;
+  }
+  int const a0 = P[0], b0 = P[1];
+  next[a0] = prev[a0] = b0;
+  next[b0] = prev[b0] = a0;
+  in[a0] = in[b0] = true;
+  for(int i=2; i<n; i++){
+    int const c = P[i];
+    int a = -1; // insertion après a
+    double best = DBL_MAX;
+    for(int j=0; j<k; j++){
+      int const v = N[c*k+j];
+      if(!in[v]) continue;
+      double const after = dist(V[v], V[c]) + dist(V[c], V[next[v]]) - dist(V[v], V[next[v]]);
+      double const before = dist(V[prev[v]], V[c]) + dist(V[c], V[v]) - dist(V[prev[v]], V[v]);
+      if(after < best) best = after, a = v;
+      if(before < best) best = before, a = prev[v];
+    }
+    if(a < 0){
+      int h = 0, t = 0;
+      B[t++] = c, seen[c] = i;
+      while(h < t && a < 0){
+        int const u = B[h++];
+        for(int j=0; j<k; j++){
+          int const v = N[u*k+j];
+          if(seen[v] == i) continue;
+          if(in[v]){ a = v; break; }
+          seen[v] = i, B[t++] = v;
+        }
+      }
+      if(a < 0) a = P[i-1];
+    }
+    next[c] = next[a], prev[c] = a;
+    prev[next[a]] = c, next[a] = c;
+    in[c] = true;
+  }
+  for(int i=0, u=a0; i<n; i++, u=next[u]) P[i] = u;
+  free(in);
+  free(seen);
+  free(B);
+  free(prev);
+  free(next);
+}
+
+static void *run(void *arg) {
+  worker *W = arg;
+  engine *E = W->E;
+  int const n = E->n, me = W->id;
+  unsigned seed = E->opt.seed + 7919 * me; // générateur propre au thread
+  int *T = malloc(n * sizeof(int));        // tournée de travail
+
+  while(true){
+    long const s = atomic_fetch_add(&E->started, 1);
+    if(E->opt.starts > 0 && s >= E->opt.starts) break;
+    if(s > 0 && ctx_done(E->ctx)) break; // au moins un départ
+
+    if(E->opt.start == START_INSERTION) random_insertion(E->V, n, T, E->N, E->k, &seed);
+    else greedy_edge(E->V, n, T, E->N, E->k, E->opt.noise, &seed);
+    double w = value(E->V, n, T);
+    if(E->opt.search & LS_2OPT) w = two_opt(E->V, n, T, E->N, E->k, NULL, E->ctx);
+    if(E->opt.search & LS_OROPT) w = or_opt(E->V, n, T, E->N, E->k, 3, E->ctx);
+
+    int b = atomic_load(&E->best);
+    if(b >= 0 && w >= atomic_load(&E->val[b])) continue; // pas meilleure
+    if(w < atomic_load(&E->val[me])){
+      memcpy(E->tour[me], T, n * sizeof(int));
+      atomic_store(&E->val[me], w);
+    }
+    // publication: me devient best tant que best n'est pas meilleur
+    while((b < 0 || atomic_load(&E->val[me]) < atomic_load(&E->val[b]))
+          && !atomic_compare_exchange_weak(&E->best, &b, me));
+  }
+
+  free(T);
+  return NULL;
+}
+
+double tsp_multistart(point *V, int n, int *P, multistart opt, context *ctx) {
+  if(n <= MS_K) return tsp_brute_force_opt(V, n, P, ctx);
+  if(opt.threads < 1) opt.threads = 1;
+  if(opt.starts <= 0 && (ctx == NULL || (ctx->deadline <= 0 && ctx->budget <= 0)))
+    opt.starts = opt.threads;
+
+  int *id = renumber(V, n, opt.threads);
+  engine E = { .V = V, .n = n, .k = MS_K, .opt = opt };
+  E.N = neighbors(V, n, E.k);
+  E.ctx = ctx;
+  atomic_init(&E.started, 0);
+  atomic_init(&E.best, -1);
+  E.val = malloc(opt.threads * sizeof(*E.val));
+  E.tour = malloc(opt.threads * sizeof(int*));
+  worker *W = malloc(opt.threads * sizeof(worker));
+  pthread_t *tid = malloc(opt.threads * sizeof(pthread_t));
+  for(int t=0; t<opt.threads; t++){
+    atomic_init(&E.val[t], DBL_MAX);
+    E.tour[t] = malloc(n * sizeof(int));
+    W[t] = (worker){ .E = &E, .id = t };
+  }
+
+  for(int t=1; t<opt.threads; t++) pthread_create(&tid[t], NULL, run, &W[t]);
+  run(&W[0]);
+  for(int t=1; t<opt.threads; t++) pthread_join(tid[t], NULL);
+
+  memcpy(P, E.tour[atomic_load(&E.best)], n * sizeof(int));
+  restore(V, n, P, id);
+
+  for(int t=0; t<opt.threads; t++) free(E.tour[t]);
+  free(tid);
+  free(W);
+  free(E.tour);
+  free(E.val);
+  free(E.N);
+  return value(V, n, P);
+}
+
+double tsp_restarts(point *V, int n, int *P) {
+  multistart const opt = {
+    .threads = sysconf(_SC_NPROCESSORS_ONLN),
+    .start = START_GREEDY,
+    .search = LS_BOTH,
+    .noise = 0.1,
+    .seed = random(),
+  };
+  context ctx;
+  ctx_init(&ctx, 2, 0);
+  return tsp_multistart(V, n, P, opt, &ctx);
+}
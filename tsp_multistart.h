@@ -0,0 +1,41 @@
+#ifndef TSP_MULTISTART_H
+#define TSP_MULTISTART_H
+
+#include "core.h"
+#include "tsp_context.h"
+
+// Les tournées de départ possibles.
+enum {
+  START_GREEDY = 0, // greedy-edge bruité
+  START_INSERTION,  // insertion dans un ordre aléatoire
+};
+
+// Les recherches locales possibles après chaque départ.
+enum {
+  LS_2OPT = 1,  // 2-opt avec listes de voisins
+  LS_OROPT = 2, // Or-opt
+  LS_BOTH = 3,  // 2-opt puis Or-opt
+};
+
+// Paramètres de tsp_multistart().
+typedef struct {
+  int threads;    // nombre de threads
+  long starts;    // nombre maximum de départs, 0 = illimité
+  int start;      // START_GREEDY ou START_INSERTION
+  int search;     // LS_2OPT, LS_OROPT ou LS_BOTH
+  double noise;   // bruit relatif du greedy-edge, par ex. 0.1
+  unsigned seed;  // graine, chaque thread en dérive la sienne
+} multistart;
+
+// Lance des départs aléatoires indépendants, chacun suivi de la
+// recherche locale choisie, sur opt.threads threads jusqu'à épuisement
+// de opt.starts ou expiration de ctx (un départ est fait par thread si
+// aucun des deux n'est limité). Écrit dans P la meilleure tournée
+// trouvée et renvoie sa valeur.
+double tsp_multistart(point *V, int n, int *P, multistart opt, context *ctx);
+
+// tsp_multistart() avec un thread par processeur, 2 secondes, greedy
+// bruité et 2-opt + Or-opt.
+double tsp_restarts(point *V, int n, int *P);
+
+#endif /* TSP_MULTISTART_H */
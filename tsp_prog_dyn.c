@@ -1,4 +1,4 @@
-#include "tools.h"
+#include "core.h"
 #include "tsp_brute_force.h"
 #include "tsp_prog_dyn.h"
 
@@ -44,44 +44,7 @@ int ExtractPath(cell **D, int t, int S, int n, int *Q) {
   return k;
 }
 
-double tsp_prog_dyn(point *V, int n, int *Q) {
-  /*
-    Version programmation dynamique du TSP. La tournée optimale
-    calculée doit être écrite dans la permutation Q, tableau qui doit
-    être alloué par l'appelant. La fonction doit renvoyer aussi la
-    valeur de la tournée Q ou 0 s'il y a eut un problème, comme la
-    pression de 'q' pour sortir de l'affichage.
-    
-    La table D est un tableau 2D de "cell" indexé par t ("int"),
-    l'indice d'un point V[t], et S ("int") représentant un ensemble
-    d'indices de points.
-
-    o D[t][S].length = longueur minimum d'un chemin allant de V[n-1] à
-      V[t] qui visite tous les points d'indice dans S
-
-    o D[t][S].pred = l'indice du point précédant V[t] dans le chemin
-      ci-dessus de longueur D[t][S].length
-
-    NB1: Ne pas lancer tsp_prog_dyn() avec n>31 car:
-         o les entiers (int sur 32 bits) ne seront pas assez grands
-           pour représenter tous les sous-ensembles;
-         o pour n=32, il faudra environ n*2^n / 10^9 = 137 secondes sur
-           un ordinateur à 1 GHz, ce qui est un peu long.
-         o l'espace mémoire, le malloc() pour la table D, risque d'être
-           problématique: 32*2^32*sizeof(cell) représente déjà 1536 Go
-           de mémoire.
-         En pratique on peut monter facilement jusqu'à n=24 pour une
-         dizaine de secondes de calcul.
- 
-    NB2: La variable globale "running" indique si l'affichage
-         graphique est actif, la pression de 'q' la faisant passer à
-         faux. L'usage de "running" permet à l'utilisateur de sortir
-         des boucles de calcul lorsqu'elles sont trop longues. Donc
-         dans la phase de test, pensez à ajouter "&& running" dans vos
-         conditions de boucle pour quitter en court de route si c'est
-         trop long.
-  */
-
+dp_state *dp_create(point *V, int n) {
   //-------------------------------------------------------------
   // Phase 1: Déclaration de la table.
   //
@@ -91,16 +54,28 @@ double tsp_prog_dyn(point *V, int n, int *Q) {
   int const L = n-1;    // L = nombre de lignes = indice du dernier point
   int const C = 1 << L; // C = nombre de colonnes
 
-  cell **D = malloc(L*sizeof(cell*)); // L=n-1 lignes
-  for (int t=0; t<L; t++) D[t] = malloc(C*sizeof(cell)); // C=2^{n-1} colonnes
-  D[0][1].length=-1; // pour savoir si la table a été remplie
+  dp_state *E = malloc(sizeof(*E));
+  *E = (dp_state){ .V = V, .n = n, .S = 1 };
+  E->D = malloc(L*sizeof(cell*)); // L=n-1 lignes
+  for (int t=0; t<L; t++) E->D[t] = malloc(C*sizeof(cell)); // C=2^{n-1} colonnes
+  if (n > 1) E->D[0][1].length=-1; // pour savoir si la table a été remplie
+  return E;
+}
 
+void dp_free(dp_state *E) {
+  for (int t=0; t<E->n-1; t++) free(E->D[t]);
+  free(E->D);
+  free(E);
+}
 
+bool dp_step(dp_state *E, long iterations) {
   //-------------------------------------------------------------
   // Phase 2: Remplissage de la table.
   //
   // o Pour toutes les colonnes S faire ...
   //   o Pour chaque ligne t de D[][S] faire ...
+  //
+  // en reprenant à la case D[E->t][E->S].
 
   // Rappel de la formule pour remplir la table D:
   // si card(S)=1, alors D[t][S] = d(V[n-1], V[t]) avec S={t};
@@ -108,14 +83,16 @@ double tsp_prog_dyn(point *V, int n, int *Q) {
   // avec t∈S et x∈S\{t}. NB: pour calculer T = S\{t}, poser
   // T=DeleteSet(S,t). On peut tester si t∈S aussi avec
   // DeleteSet(S,t).
-  
-  for(int S = 1; S<C; S++){
-    
-    for(int t = 0; t<L; t++){
 
-      int T = DeleteSet(S,t);
+  int const n = E->n, L = n-1, C = 1 << L;
+  cell **D = E->D;
+  point *V = E->V;
 
-      if(T == S) continue;
+  while (E->S < C && iterations > 0) {
+    int const S = E->S, t = E->t;
+    int T = DeleteSet(S,t);
+
+    if (T != S) {
       // ici t est dans S
       if(T == 0){// Il faut juste calculé la distance de Vi t
         D[t][S].length = dist(V[n-1], V[t]);
@@ -135,34 +112,43 @@ double tsp_prog_dyn(point *V, int n, int *Q) {
         D[t][S].length = min;
         D[t][S].pred = xMin;
       }
-      int k = ExtractPath(D, t, S, n, Q); // extrait Q depuis D[t][S]
-      drawPath(V, n, Q, k); // dessine le chemin Q              
-      if (!running) return 0;             // on arrête tout si 'q' est pressée 
+      E->lS = S, E->lt = t;
+      iterations--;
     }
+
+    if (++E->t == L) E->t = 0, E->S++; // case suivante
   }
 
-  // Toujours dans la boucle, mais à la fin, lorsque le calcul de la
-  // cellule D[t][S] est fait (c'est-à-dire les valeurs D[t][S].length
-  // et D[t][S].pred correctement calcuées), vous pouvez afficher le
-  // chemin Q correspondant à la case D[t][S] à l'aide d'ExtractPath()
-  // puis de drawPath() comme ci-dessous:
-  //
-  //
-  // Ici, c'est la fin des deux boucles. Le calcul de la table est
-  // terminé.
-  
+  return E->S >= C;
+}
 
+double dp_tour(dp_state *E, int *Q) {
   //-------------------------------------------------------------
   // Phase 3: Extraction de la tournée optimale.
   //
   // On notera w la longueur de la tournée optimale qui reste à
-  // calculer. NB: si le calcul a été interrompu (pression de 'q'), il
-  // faut renvoyer 0.
+  // calculer. NB: si le calcul n'est pas terminé, on complète le
+  // dernier chemin calculé avec les points qui n'y sont pas.
 
+  int const n = E->n, L = n-1, C = 1 << L;
+  point *V = E->V;
+  cell **D = E->D;
   double w = 0; // valeur par défaut
 
-  if (running) {
-    // Si 'q' n'a pas été pressée, il faut calculer w puis extraire la
+  if (n < 3) {
+    for(int i=0; i<n; i++) Q[i] = i;
+    return value(V, n, Q);
+  }
+
+  if (E->S < C) {
+    int k = (E->lS > 0)? ExtractPath(D, E->lt, E->lS, n, Q) : 0;
+    bool *in = calloc(n, sizeof(bool));
+    for(int i=0; i<k; i++) in[Q[i]] = true;
+    for(int u=0; u<n; u++) if(!in[u]) Q[k++] = u;
+    free(in);
+    w = value(V, n, Q);
+  } else {
+    // Le calcul est terminé: il faut calculer w puis extraire la
     // tournée Q correspondante à l'aide d'ExtractPath(...,Q).
     w = DBL_MAX;
     int minT = n;
@@ -174,16 +160,138 @@ double tsp_prog_dyn(point *V, int n, int *Q) {
         minT = t;
       }
     }
-    int j = ExtractPath(D, minT, C-1, n, Q);
-    drawPath(V, n, Q, j);
+    ExtractPath(D, minT, C-1, n, Q);
+  }
+
+  return w;
+}
+
+//
+//  Points de reprise: en-tête "TSPD", le nombre s de colonnes
+//  enregistrées, puis pour chaque colonne S=1..s-1 et chaque t∈S les
+//  valeurs D[t][S].length (double) et D[t][S].pred (octet, car n<32).
+//  Seules les cases utiles sont donc écrites.
+//
+
+// Taille du tampon d'écriture, en nombre de cases.
+#define DP_BLOCK 4096
+
+void dp_save(FILE *f, void *arg) {
+  dp_state *E = arg;
+  int const L = E->n-1;
+  unsigned char buf[DP_BLOCK * (sizeof(double)+1)];
+  size_t m = 0;
+  ckpt_header(f, "TSPD", E->V, E->n);
+  fwrite(&E->saved, sizeof(E->saved), 1, f);
+  for(int S=1; S<E->saved; S++)
+    for(int t=0; t<L; t++){
+      if(DeleteSet(S,t) == S) continue;
+      memcpy(buf + m, &E->D[t][S].length, sizeof(double));
+      buf[m + sizeof(double)] = E->D[t][S].pred;
+      m += sizeof(double)+1;
+      if(m == sizeof(buf)) fwrite(buf, 1, m, f), m = 0;
+    }
+  fwrite(buf, 1, m, f);
+}
+
+bool dp_checkpoint(dp_state *E, checkpoint *K) {
+  // Les colonnes S < E->S ne sont plus modifiées par dp_step(): le
+  // thread d'écriture les lit directement dans D, sans copie.
+  if(ckpt_busy(K)) return false;
+  E->saved = E->S;
+  return ckpt_post(K, dp_save, E);
+}
+
+dp_state *dp_load(point *V, int n, const char *path) {
+  FILE *f = fopen(path, "rb");
+  if(f == NULL) return NULL;
+  int const L = n-1, C = 1 << L;
+  int s;
+  if(!ckpt_check(f, "TSPD", V, n) || fread(&s, sizeof(s), 1, f) != 1 || s < 1 || s > C){
+    fclose(f);
+    return NULL;
+  }
+  dp_state *E = dp_create(V, n);
+  unsigned char c[sizeof(double)+1];
+  bool ok = true;
+  for(int S=1; S<s && ok; S++)
+    for(int t=0; t<L && ok; t++){
+      if(DeleteSet(S,t) == S) continue;
+      ok = (fread(c, sizeof(c), 1, f) == 1);
+      memcpy(&E->D[t][S].length, c, sizeof(double));
+      E->D[t][S].pred = c[sizeof(double)];
+    }
+  fclose(f);
+  if(!ok){
+    dp_free(E);
+    return NULL;
+  }
+  E->S = E->saved = s;
+  if(s > 1){ // dernière case calculée: le plus grand t de la colonne s-1
+    E->lS = s-1;
+    for(int t=0; t<L; t++) if(DeleteSet(s-1,t) != s-1) E->lt = t;
+  }
+  return E;
+}
+
+double tsp_prog_dyn(point *V, int n, int *Q, context *ctx) {
+  /*
+    Version programmation dynamique du TSP. La tournée optimale
+    calculée doit être écrite dans la permutation Q, tableau qui doit
+    être alloué par l'appelant. La fonction doit renvoyer aussi la
+    valeur de la tournée Q. Si le contexte ctx expire (une itération
+    par case de la table), Q est le dernier chemin calculé complété
+    par les points manquants. Le calcul lui-même est fait par étapes
+    par dp_step() (cf. tsp_prog_dyn.h), ce qui permet de l'interrompre,
+    de l'enregistrer et de le reprendre plus tard.
+    
+    La table D est un tableau 2D de "cell" indexé par t ("int"),
+    l'indice d'un point V[t], et S ("int") représentant un ensemble
+    d'indices de points.
+
+    o D[t][S].length = longueur minimum d'un chemin allant de V[n-1] à
+      V[t] qui visite tous les points d'indice dans S
+
+    o D[t][S].pred = l'indice du point précédant V[t] dans le chemin
+      ci-dessus de longueur D[t][S].length
+
+    NB1: Ne pas lancer tsp_prog_dyn() avec n>31 car:
+         o les entiers (int sur 32 bits) ne seront pas assez grands
+           pour représenter tous les sous-ensembles;
+         o pour n=32, il faudra environ n*2^n / 10^9 = 137 secondes sur
+           un ordinateur à 1 GHz, ce qui est un peu long.
+         o l'espace mémoire, le malloc() pour la table D, risque d'être
+           problématique: 32*2^32*sizeof(cell) représente déjà 1536 Go
+           de mémoire.
+         En pratique on peut monter facilement jusqu'à n=24 pour une
+         dizaine de secondes de calcul.
+ 
+    NB2: Le contexte ctx (cf. tsp_context.h) permet de sortir des
+         boucles de calcul lorsqu'elles sont trop longues: date
+         limite, budget, ou annulation (par exemple par la fonction
+         de progression de tsp_main.c lorsque 'q' est pressée). Le
+         chemin de la case courante n'est extrait pour la fonction de
+         progression que lorsqu'elle le demande (ctx_due()).
+  */
+
+  dp_state *E = dp_create(V, n);
+
+  // Remplit la table case par case. Lorsque la fonction de progression
+  // le demande, on lui montre le chemin Q de la dernière case calculée
+  // D[t][S], extrait à l'aide d'ExtractPath().
+  while (!dp_step(E, 1)) {
+    if (ctx_due(ctx)) {
+      int k = ExtractPath(E->D, E->lt, E->lS, n, Q); // extrait Q depuis D[t][S]
+      ctx_report(ctx, V, n, Q, k);
+    }
+    if (ctx_step(ctx, n)) break; // on arrête tout
   }
 
+  double w = dp_tour(E, Q);
 
   //-------------------------------------------------------------
   // Phase 4: Valeur retour en libérant la table D.
-  ;
-  ;
-  ;
+  dp_free(E);
 
   return w;
 }
@@ -1,7 +1,9 @@
 #ifndef TSP_PROG_DYN_H
 #define TSP_PROG_DYN_H
 
-#include "tools.h"
+#include "core.h"
+#include "tsp_context.h"
+#include "tsp_checkpoint.h"
 
 // Une cellule de la table.
 typedef struct {
@@ -11,6 +13,46 @@ typedef struct {
 
 int DeleteSet(int S, int i);
 int ExtractPath(cell **D, int t, int S, int n, int *Q);
-double tsp_prog_dyn(point *V, int n, int *Q);
+double tsp_prog_dyn(point *V, int n, int *Q, context *ctx);
+
+// État d'un calcul par étapes de la table D: la prochaine case à
+// calculer est D[t][S], et la dernière calculée D[lt][lS] (lS=0 si
+// aucune).
+typedef struct {
+  point *V;
+  int n;
+  cell **D;
+  int S, t;
+  int lS, lt;
+  int saved; // colonnes 1..saved-1 enregistrées par dp_checkpoint()
+} dp_state;
+
+// Crée l'état d'un calcul qui commence.
+dp_state *dp_create(point *V, int n);
+
+// Calcule au plus "iterations" cases de D. Renvoie vrai si la table
+// est complète.
+bool dp_step(dp_state *E, long iterations);
+
+// Écrit dans Q la tournée optimale si la table est complète, sinon le
+// chemin de la dernière case calculée complété par les points
+// manquants. Renvoie la valeur de Q.
+double dp_tour(dp_state *E, int *Q);
+
+// Demande au thread de K d'enregistrer les colonnes terminées de D.
+// Ne bloque pas: renvoie faux si l'écriture précédente n'est pas
+// finie. Il faut attendre la fin de l'écriture (ckpt_wait()) avant
+// dp_free().
+bool dp_checkpoint(dp_state *E, checkpoint *K);
+
+// Écriture d'un point de reprise de E (void*), pour ckpt_post().
+void dp_save(FILE *f, void *E);
+
+// Reprend le calcul enregistré dans le fichier path pour les points V.
+// Renvoie NULL si le fichier est absent, illisible ou correspond à
+// d'autres points.
+dp_state *dp_load(point *V, int n, const char *path);
+
+void dp_free(dp_state *E);
 
 #endif /* TSP_PROG_DYN_H */
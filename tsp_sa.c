@@ -0,0 +1,262 @@
+#include "core.h"
+#include "tsp_brute_force.h"
+#include "tsp_heuristic.h"
+#include "tsp_sa.h"
+#include <pthread.h>
+#include <stdint.h>
+
+//
+//  TSP - RECUIT SIMULÉ
+//
+//  La tournée est le tableau P avec pos[P[i]]=i. Un mouvement est tiré
+//  à partir d'un point a au hasard et d'un de ses k voisins candidats:
+//
+//  - 2-opt: a-b et c-d remplacées par a-c et b-d (b,d successeurs);
+//  - Or-opt: le segment s1..sL (L=1..3) qui suit a est déplacé entre
+//    c et son successeur d, à l'endroit ou à l'envers;
+//  - échange: a et c échangent leurs places.
+//
+//  Le coût d'un mouvement (delta) ne dépend que des quelques arêtes
+//  modifiées, donc se calcule en O(1). Seuls les mouvements acceptés
+//  modifient P, par des renversements (2-opt et Or-opt) qui portent sur
+//  la plus courte des deux parties de la tournée. Les 2-opt et Or-opt
+//  entre deux points distants de plus de span places dans la tournée
+//  sont ignorés: à haute température, ces longs renversements
+//  rendraient les grandes instances très lentes. span vaut
+//  SA_SPAN*sqrt(n), au moins SA_SPAN_MIN.
+//
+
+#define SA_K 8            // nombre de voisins candidats
+#define SA_SPAN 5         // span = SA_SPAN*sqrt(n) ...
+#define SA_SPAN_MIN 1000  // ... mais au moins SA_SPAN_MIN
+
+// Générateur xorshift64*, propre à chaque réplique.
+static inline uint64_t rng(uint64_t *s) {
+  *s ^= *s >> 12;
+  *s ^= *s << 25;
+  *s ^= *s >> 27;
+  return *s * 2685821657736338717ULL;
+}
+
+// Réel aléatoire dans [0,1[.
+static inline double rng01(uint64_t *s) {
+  return (rng(s) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Une réplique: sa tournée courante et la meilleure vue.
+typedef struct {
+  point *V;
+  int n, *N;
+  int span;         // distance maximum entre a et c dans P
+  int *P, *pos;
+  double cur;       // valeur de P
+  int *best;        // meilleure tournée vue
+  double wbest;     // sa valeur
+  double T;         // température courante
+  long moves;       // mouvements à faire dans l'époque
+  uint64_t seed;
+  context *ctx;
+} replica;
+
+// Successeur de x dans le sens du tableau.
+static inline int succ(replica *R, int x) {
+  int const i = R->pos[x] + 1;
+  return R->P[(i == R->n)? 0 : i];
+}
+
+// Remplace a-b et c-d par a-c et b-d, où b suit a et d suit c dans un
+// même sens de parcours (celui du tableau ou l'inverse).
+static inline void move2(replica *R, int a, int b, int c, int d) {
+  if(succ(R, a) == b) reverse_tour(R->P, R->pos, R->n, R->pos[b], R->pos[c]);
+  else reverse_tour(R->P, R->pos, R->n, R->pos[c], R->pos[b]);
+}
+
+// Vrai si a et c sont trop loin dans la tournée pour un renversement.
+static inline bool too_far(replica *R, int a, int c) {
+  int const len = abs(R->pos[c] - R->pos[a]);
+  return len > R->span && R->n - len > R->span;
+}
+
+static inline double d(replica *R, int u, int v) {
+  return dist(R->V[u], R->V[v]);
+}
+
+// Critère de Metropolis.
+static inline bool accept(replica *R, double delta) {
+  return delta <= 0 || rng01(&R->seed) < exp(-delta / R->T);
+}
+
+// Tire et évalue un mouvement, et l'applique s'il est accepté.
+static void step(replica *R) {
+  int const n = R->n;
+  int const a = rng(&R->seed) % n;
+  int const c = R->N[a*SA_K + rng(&R->seed) % SA_K];
+  int const type = rng(&R->seed) % 3;
+
+  if(type == 0){ // 2-opt
+    int const b = succ(R, a), dd = succ(R, c);
+    if(c == b || dd == a || too_far(R, a, c)) return;
+    double const delta = d(R,a,c) + d(R,b,dd) - d(R,a,b) - d(R,c,dd);
+    if(!accept(R, delta)) return;
+    move2(R, a, b, c, dd);
+    R->cur += delta;
+    return;
+  }
+
+  if(type == 1){ // Or-opt du segment s1..sL qui suit a, vers c-dd
+    if(too_far(R, a, c)) return;
+    int const L = 1 + rng(&R->seed) % 3;
+    int const s1 = succ(R, a);
+    int sL = s1;
+    for(int i=1; i<L; i++) sL = succ(R, sL);
+    int const q = succ(R, sL), dd = succ(R, c);
+    if(q == a || c == a || dd == a) return;
+    for(int x=s1; ; x=succ(R, x)){ // c et dd hors du segment
+      if(x == c || x == dd) return;
+      if(x == sL) break;
+    }
+    double const base = d(R,a,q) - d(R,a,s1) - d(R,sL,q) - d(R,c,dd);
+    double const rev = base + d(R,c,sL) + d(R,s1,dd); // c-sL..s1-dd
+    double const fwd = base + d(R,c,s1) + d(R,sL,dd); // c-s1..sL-dd
+    double const delta = fmin(rev, fwd);
+    if(!accept(R, delta)) return;
+    move2(R, a, s1, c, dd);  // a-c ... q-sL..s1-dd
+    move2(R, a, c, q, sL);   // a-q ... c-sL..s1-dd
+    if(fwd < rev) move2(R, c, sL, s1, dd); // c-s1..sL-dd
+    R->cur += delta;
+    return;
+  }
+
+  // échange de a et c, non voisins dans la tournée
+  int const i = R->pos[a], j = R->pos[c];
+  int const pa = R->P[(i-1+n)%n], na = R->P[(i+1)%n];
+  int const pc = R->P[(j-1+n)%n], nc = R->P[(j+1)%n];
+  if(c == pa || c == na) return;
+  double const delta = d(R,pa,c) + d(R,c,na) + d(R,pc,a) + d(R,a,nc)
+                     - d(R,pa,a) - d(R,a,na) - d(R,pc,c) - d(R,c,nc);
+  if(!accept(R, delta)) return;
+  R->P[i] = c, R->pos[c] = i;
+  R->P[j] = a, R->pos[a] = j;
+  R->cur += delta;
+}
+
+// Une époque d'une réplique (exécutée par un thread).
+static void *epoch(void *arg) {
+  replica *R = arg;
+  for(long m=0; m<R->moves; m++){
+    if((m & 1023) == 0 && ctx_step(R->ctx, 1024*16)) break;
+    step(R);
+  }
+  R->cur = value(R->V, R->n, R->P); // évite la dérive des arrondis
+  if(R->cur < R->wbest){
+    R->wbest = R->cur;
+    memcpy(R->best, R->P, R->n * sizeof(int));
+  }
+  return NULL;
+}
+
+// Température de la réplique la plus froide à la progression f.
+static double cooling(annealing *A, double f) {
+  switch(A->cooling){
+  case COOL_LINEAR: return A->t0 + (A->t1 - A->t0) * f;
+  case COOL_LUNDY:  return A->t0 / (1 + f * (A->t0 / A->t1 - 1));
+  default:          return A->t0 * pow(A->t1 / A->t0, f);
+  }
+}
+
+double tsp_sa(point *V, int n, int *P, annealing opt, context *ctx) {
+  if(n <= SA_K) return tsp_brute_force_opt(V, n, P, ctx);
+  int const r = (opt.replicas < 1)? 1 : opt.replicas;
+  if(opt.epoch <= 0) opt.epoch = 100000;
+  if(opt.ladder < 1) opt.ladder = 1;
+  int *N = neighbors(V, n, SA_K);
+  int const span = fmax(SA_SPAN_MIN, SA_SPAN * sqrt(n));
+
+  replica *R = malloc(r * sizeof(replica));
+  int *rank = malloc(r * sizeof(int)); // rank[i] = réplique à la i-ème température
+  for(int i=0; i<r; i++){
+    R[i] = (replica){ .V = V, .n = n, .N = N, .span = span, .ctx = ctx };
+    R[i].P = malloc(n * sizeof(int));
+    R[i].pos = malloc(n * sizeof(int));
+    R[i].best = malloc(n * sizeof(int));
+    memcpy(R[i].P, P, n * sizeof(int));
+    memcpy(R[i].best, P, n * sizeof(int));
+    for(int j=0; j<n; j++) R[i].pos[P[j]] = j;
+    R[i].cur = R[i].wbest = value(V, n, P);
+    R[i].seed = 0x9E3779B97F4A7C15ULL * (opt.seed + i + 1);
+    rank[i] = i;
+  }
+
+  if(opt.t0 <= 0){ // moyenne des deltas positifs de 2-opt candidats
+    double sum = 0;
+    int m = 0;
+    for(int t=0; t<1000; t++){
+      int const a = rng(&R[0].seed) % n, c = N[a*SA_K + rng(&R[0].seed) % SA_K];
+      int const b = succ(&R[0], a), dd = succ(&R[0], c);
+      if(c == a || c == b || dd == a) continue;
+      double const delta = d(&R[0],a,c) + d(&R[0],b,dd) - d(&R[0],a,b) - d(&R[0],c,dd);
+      if(delta > 0) sum += delta, m++;
+    }
+    opt.t0 = (m > 0)? 0.5 * sum / m : 1;
+    if(opt.t1 <= 0 || opt.t1 >= opt.t0) opt.t1 = 1E-4 * opt.t0;
+  }
+  if(opt.t1 <= 0) opt.t1 = 1E-4 * opt.t0;
+
+  // sans nombre de mouvements, la progression est celle du temps
+  // jusqu'à la date limite de ctx
+  double const start = ctx_now();
+  bool const timed = (opt.moves <= 0 && ctx && ctx->deadline > start);
+  if(opt.moves <= 0 && !timed) opt.moves = 200L * n + 1000000;
+
+  pthread_t *tid = malloc(r * sizeof(pthread_t));
+  for(long done=0; (timed || done<opt.moves) && !ctx_done(ctx); done+=opt.epoch){
+    double const f = timed? fmin(1, (ctx_now() - start) / (ctx->deadline - start))
+                          : (double)done / opt.moves;
+    double const Tc = cooling(&opt, f);
+    for(int i=0; i<r; i++){
+      R[rank[i]].T = Tc * pow(opt.ladder, i);
+      R[rank[i]].moves = (timed || opt.moves - done >= opt.epoch)? opt.epoch : opt.moves - done;
+    }
+    for(int i=1; i<r; i++) pthread_create(&tid[i], NULL, epoch, &R[i]);
+    epoch(&R[0]);
+    for(int i=1; i<r; i++) pthread_join(tid[i], NULL);
+
+    // échange de températures entre répliques voisines, accepté avec
+    // probabilité min(1, exp((E_i-E_j)(1/T_i-1/T_j)))
+    for(int i=0; i+1<r; i++){
+      replica *A = &R[rank[i]], *B = &R[rank[i+1]];
+      double const x = (A->cur - B->cur) * (1/A->T - 1/B->T);
+      if(x >= 0 || rng01(&R[0].seed) < exp(x)){
+        int const t = rank[i];
+        rank[i] = rank[i+1], rank[i+1] = t;
+      }
+    }
+  }
+
+  int b = 0;
+  for(int i=1; i<r; i++) if(R[i].wbest < R[b].wbest) b = i;
+  memcpy(P, R[b].best, n * sizeof(int));
+  for(int i=0; i<r; i++){
+    free(R[i].P);
+    free(R[i].pos);
+    free(R[i].best);
+  }
+  free(tid);
+  free(rank);
+  free(R);
+  free(N);
+  return value(V, n, P);
+}
+
+double tsp_annealing(point *V, int n, int *P) {
+  tsp_greedy_edge(V, n, P);
+  annealing const opt = {
+    .replicas = sysconf(_SC_NPROCESSORS_ONLN),
+    .moves = 200L * n + 1000000,
+    .epoch = 100000,
+    .ladder = 1.5,
+    .cooling = COOL_GEOMETRIC,
+    .seed = random(),
+  };
+  return tsp_sa(V, n, P, opt, NULL);
+}
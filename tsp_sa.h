@@ -0,0 +1,40 @@
+#ifndef TSP_SA_H
+#define TSP_SA_H
+
+#include "core.h"
+#include "tsp_context.h"
+
+// Les schémas de refroidissement, pour une progression f de 0 à 1.
+enum {
+  COOL_GEOMETRIC = 0, // T = t0 * (t1/t0)^f
+  COOL_LINEAR,        // T = t0 + (t1-t0) * f
+  COOL_LUNDY,         // T = t0 / (1 + f*(t0/t1-1)), Lundy & Mees
+};
+
+// Paramètres de tsp_sa().
+typedef struct {
+  int replicas;   // nombre de répliques, une par thread (>=1)
+  long moves;     // nombre de mouvements évalués par réplique, 0 pour
+                  // un refroidissement réglé sur la date limite de ctx
+  long epoch;     // mouvements entre deux échanges de répliques
+  double t0, t1;  // températures initiale et finale de la réplique la
+                  // plus froide, t0<=0 pour un choix automatique
+  double ladder;  // rapport de température entre répliques voisines
+  int cooling;    // COOL_GEOMETRIC, COOL_LINEAR ou COOL_LUNDY
+  unsigned seed;  // graine
+} annealing;
+
+// Recuit simulé qui améliore la tournée P (qui doit être valide) par
+// des mouvements 2-opt, Or-opt et échanges tirés dans les listes de
+// voisins et évalués en O(1). Avec plusieurs répliques, chacune tourne
+// sur son thread à sa propre température, et les répliques voisines
+// échangent leurs températures (parallel tempering). S'arrête aussi si
+// ctx expire (une itération pour 1024 mouvements). Écrit dans P la
+// meilleure tournée rencontrée et renvoie sa valeur.
+double tsp_sa(point *V, int n, int *P, annealing opt, context *ctx);
+
+// Greedy-edge puis tsp_sa() avec un thread par processeur et des
+// paramètres par défaut.
+double tsp_annealing(point *V, int n, int *P);
+
+#endif /* TSP_SA_H */
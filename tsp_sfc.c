@@ -0,0 +1,180 @@
+#include "core.h"
+#include "tsp_brute_force.h"
+#include "tsp_heuristic.h"
+#include "tsp_sfc.h"
+#include <pthread.h>
+#include <stdint.h>
+
+//
+//  TSP - COURBE DE HILBERT
+//
+//  Chaque point reçoit la clé de sa case sur une grille 2^16 x 2^16
+//  parcourue par la courbe de Hilbert. Les couples (clé,indice) sont
+//  rangés dans des entiers 64 bits (clé en poids fort) puis triés par
+//  un tri par base (radix sort) de 4 passes de 8 bits sur la clé. Le
+//  tout est en O(n), et se découpe en tranches de points traitées en
+//  parallèle.
+//
+//  Le même ordre sert à renuméroter les points avant de lancer un
+//  solveur: deux points proches dans le plan ont alors des indices
+//  proches, et les accès V[P[i]], V[P[j]] ou aux listes de voisins
+//  (toutes construites par les solveurs à partir de V) restent dans
+//  les mêmes lignes de cache et pages mémoire.
+//
+
+#define HILBERT_ORDER 16   // grille 2^16 x 2^16
+#define RADIX_BITS 8       // chiffres de 8 bits
+#define RADIX (1<<RADIX_BITS)
+
+// Renvoie l'indice de la case (x,y) sur la courbe de Hilbert.
+static uint32_t hilbert(uint32_t x, uint32_t y) {
+  uint32_t const m = (1u << HILBERT_ORDER) - 1;
+  uint32_t d = 0, t;
+  for(uint32_t s = 1u << (HILBERT_ORDER-1); s > 0; s >>= 1){
+    uint32_t const rx = (x & s) > 0, ry = (y & s) > 0;
+    d += s * s * ((3 * rx) ^ ry);
+    if(ry == 0){ // rotation du quadrant
+      if(rx == 1) x = m - x, y = m - y;
+      SWAP(x, y, t);
+    }
+  }
+  return d;
+}
+
+// Ce que fait un thread: la tranche [a,b[ des points, et son
+// histogramme pour la passe courante du tri.
+typedef struct {
+  point *V;
+  uint64_t *K, *T; // clés à trier et tableau de destination
+  int a, b;
+  double x0, y0, s; // case (x,y) = ((V.x-x0)*s, (V.y-y0)*s)
+  int shift;        // chiffre trié = (K >> shift) & (RADIX-1)
+  int count[RADIX]; // histogramme, puis positions de destination
+} job;
+
+static void *keys(void *arg) {
+  job *J = arg;
+  for(int i=J->a; i<J->b; i++){
+    uint32_t const x = (J->V[i].x - J->x0) * J->s;
+    uint32_t const y = (J->V[i].y - J->y0) * J->s;
+    J->K[i] = ((uint64_t)hilbert(x, y) << 32) | (uint32_t)i;
+  }
+  return NULL;
+}
+
+static void *histogram(void *arg) {
+  job *J = arg;
+  memset(J->count, 0, sizeof(J->count));
+  for(int i=J->a; i<J->b; i++) J->count[(J->K[i] >> J->shift) & (RADIX-1)]++;
+  return NULL;
+}
+
+static void *scatter(void *arg) {
+  job *J = arg;
+  for(int i=J->a; i<J->b; i++) J->T[J->count[(J->K[i] >> J->shift) & (RADIX-1)]++] = J->K[i];
+  return NULL;
+}
+
+// Lance f() sur chacun des t jobs (le dernier dans le thread courant).
+static void run(void *(*f)(void*), job *J, int t) {
+  pthread_t *id = malloc(t * sizeof(pthread_t));
+  for(int i=0; i<t-1; i++) pthread_create(&id[i], NULL, f, &J[i]);
+  f(&J[t-1]);
+  for(int i=0; i<t-1; i++) pthread_join(id[i], NULL);
+  free(id);
+}
+
+void hilbert_order(point *V, int n, int *P, int threads) {
+  if(n <= 0) return;
+  int const t = (threads < 1)? 1 : (threads > n)? n : threads;
+
+  double xmin = V[0].x, xmax = V[0].x, ymin = V[0].y, ymax = V[0].y;
+  for(int i=1; i<n; i++){
+    xmin = fmin(xmin, V[i].x); xmax = fmax(xmax, V[i].x);
+    ymin = fmin(ymin, V[i].y); ymax = fmax(ymax, V[i].y);
+  }
+  double const side = fmax(fmax(xmax-xmin, ymax-ymin), 1E-300);
+
+  uint64_t *K = malloc(n * sizeof(uint64_t));
+  uint64_t *T = malloc(n * sizeof(uint64_t));
+  job *J = malloc(t * sizeof(job));
+  for(int j=0; j<t; j++)
+    J[j] = (job){ .V = V, .K = K, .T = T,
+                  .a = (long)n*j/t, .b = (long)n*(j+1)/t,
+                  .x0 = xmin, .y0 = ymin,
+                  .s = ((1u << HILBERT_ORDER) - 1) / side };
+  run(keys, J, t);
+
+  // tri par base, stable, des chiffres de poids faible vers les forts:
+  // le tranche j d'un chiffre c est écrite après toutes les tranches
+  // <j de ce chiffre, et après tous les chiffres <c
+  for(int shift=32; shift<64; shift+=RADIX_BITS){
+    for(int j=0; j<t; j++) J[j].shift = shift, J[j].K = K, J[j].T = T;
+    run(histogram, J, t);
+    int pos = 0;
+    for(int c=0; c<RADIX; c++)
+      for(int j=0; j<t; j++){
+        int const m = J[j].count[c];
+        J[j].count[c] = pos;
+        pos += m;
+      }
+    run(scatter, J, t);
+    uint64_t *tmp;
+    SWAP(K, T, tmp);
+  }
+
+  for(int i=0; i<n; i++) P[i] = (uint32_t)K[i];
+  free(J);
+  free(T);
+  free(K);
+}
+
+// nombre de voisins candidats pour l'Or-opt
+#define SFC_K 5
+
+int *renumber(point *V, int n, int threads) {
+  int *id = malloc(n * sizeof(int));
+  hilbert_order(V, n, id, threads);
+  point *W = malloc(n * sizeof(point));
+  for(int i=0; i<n; i++) W[i] = V[id[i]];
+  memcpy(V, W, n * sizeof(point));
+  free(W);
+  return id;
+}
+
+void restore(point *V, int n, int *P, int *id) {
+  point *W = malloc(n * sizeof(point));
+  for(int i=0; i<n; i++) W[id[i]] = V[i];
+  memcpy(V, W, n * sizeof(point));
+  free(W);
+  if(P && n > 0 && P[0] >= 0)
+    for(int i=0; i<n; i++) P[i] = id[P[i]];
+  free(id);
+}
+
+double tsp_renumbered(point *V, int n, int *P, constructor solve) {
+  int *id = renumber(V, n, sysconf(_SC_NPROCESSORS_ONLN));
+  solve(V, n, P);
+  restore(V, n, P, id);
+  return value(V, n, P);
+}
+
+double tsp_sfc(point *V, int n, int *P, int threads, int passes, context *ctx) {
+  if(passes <= 0 || n < 8){
+    hilbert_order(V, n, P, threads);
+    return value(V, n, P);
+  }
+  // une fois renumérotés, la tournée de Hilbert est l'identité et
+  // l'Or-opt accède à des voisins d'indices proches
+  int *id = renumber(V, n, threads);
+  for(int i=0; i<n; i++) P[i] = i;
+  int *N = neighbors(V, n, SFC_K);
+  or_opt(V, n, P, N, SFC_K, passes, ctx);
+  free(N);
+  restore(V, n, P, id);
+  return value(V, n, P);
+}
+
+double tsp_hilbert(point *V, int n, int *P) {
+  return tsp_sfc(V, n, P, sysconf(_SC_NPROCESSORS_ONLN), 2, NULL);
+}
@@ -0,0 +1,34 @@
+#ifndef TSP_SFC_H
+#define TSP_SFC_H
+
+#include "core.h"
+#include "tsp_heuristic.h"
+
+// Écrit dans P les indices des n points de V triés selon leur
+// position sur la courbe de Hilbert (tri par base sur les clés), avec
+// "threads" threads (1 pour un calcul séquentiel).
+void hilbert_order(point *V, int n, int *P, int threads);
+
+// Renumérote sur place les points de V dans l'ordre de la courbe de
+// Hilbert. Le tableau renvoyé donne id[i] = ancien indice du nouveau
+// point V[i]. À appeler avant de résoudre, les structures annexes
+// (distances, listes de voisins) étant alors construites dans le
+// nouvel ordre.
+int *renumber(point *V, int n, int threads);
+
+// Annule renumber(): remet V dans l'ordre d'origine, traduit la tournée
+// P (si P!=NULL et P[0]>=0) en indices d'origine, puis libère id.
+void restore(point *V, int n, int *P, int *id);
+
+// Lance solve() sur les points renumérotés, et renvoie la valeur de la
+// tournée P exprimée dans la numérotation d'origine.
+double tsp_renumbered(point *V, int n, int *P, constructor solve);
+
+// Tournée selon la courbe de Hilbert suivie de "passes" passes
+// d'Or-opt, interrompues si ctx expire. Renvoie sa valeur.
+double tsp_sfc(point *V, int n, int *P, int threads, int passes, context *ctx);
+
+// Comme tsp_sfc() avec un thread par processeur et 2 passes d'Or-opt.
+double tsp_hilbert(point *V, int n, int *P);
+
+#endif /* TSP_SFC_H */